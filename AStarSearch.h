@@ -0,0 +1,444 @@
+#ifndef ASTARSEARCH_H
+#define ASTARSEARCH_H
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include "CompactGraph.h"
+#include "CostTraits.h"
+#include "PriorityQueues.h"
+
+// ----------------------------------------------------------------
+//  Name:           NullSearchObserver
+//  Description:    The default observer for AStarSearch: told of
+//                  every expansion and does nothing. An observer
+//                  with an expand( node, cost ) member can be passed
+//                  to run() instead, for example to record a trace.
+// ----------------------------------------------------------------
+struct NullSearchObserver {
+    template<class Cost>
+    void expand( int, Cost ) {}
+};
+
+// ----------------------------------------------------------------
+//  Name:           ArcDirection
+//  Description:    Reads a node's arcs forwards (the arcs leaving
+//                  it) or, with Reverse set, backwards (the arcs
+//                  entering it). Only the direction used is ever
+//                  compiled, so a graph without reverse arcs can
+//                  still be searched forwards.
+// ----------------------------------------------------------------
+template<bool Reverse>
+struct ArcDirection {
+    template<class GraphType>
+    static int begin( GraphType const & graph, int node ) { return graph.begin( node ); }
+    template<class GraphType>
+    static int end( GraphType const & graph, int node ) { return graph.end( node ); }
+    template<class GraphType>
+    static int node( GraphType const & graph, int arc ) { return graph.target( arc ); }
+    template<class GraphType>
+    static auto weight( GraphType const & graph, int arc ) -> decltype( graph.weight( arc ) ) { return graph.weight( arc ); }
+};
+
+template<>
+struct ArcDirection<true> {
+    template<class GraphType>
+    static int begin( GraphType const & graph, int node ) { return graph.rbegin( node ); }
+    template<class GraphType>
+    static int end( GraphType const & graph, int node ) { return graph.rend( node ); }
+    template<class GraphType>
+    static int node( GraphType const & graph, int arc ) { return graph.source( arc ); }
+    template<class GraphType>
+    static auto weight( GraphType const & graph, int arc ) -> decltype( graph.rweight( arc ) ) { return graph.rweight( arc ); }
+};
+
+// ----------------------------------------------------------------
+//  Name:           AStarSearch
+//  Description:    A* over a CompactGraph with all per-query state
+//                  (costs, parents, closed flags) held in arrays
+//                  owned by the search, not in the graph's nodes.
+//                  The arrays are reused between queries; only the
+//                  entries a query touched are reset.
+//
+//                  An expanded node is never opened again, so the
+//                  heuristic must be consistent, not just
+//                  admissible: for every arc, h( from ) <= weight +
+//                  h( to ), and h( goal ) = 0. The straight line
+//                  distance is, as is the smallest of several
+//                  consistent estimates. With an h that only never
+//                  overestimates a node can be closed on a dearer
+//                  path and the result is then not the cheapest;
+//                  use Graph::aStar, which re-opens nodes, for such
+//                  heuristics.
+//
+//                  Cost is the type costs are kept in and is chosen
+//                  at compile time through CostTraits. Arc weights
+//                  are multiplied by the fixed-point scale and
+//                  rounded up; heuristic values are multiplied by
+//                  the same scale and rounded down, so a consistent
+//                  heuristic stays consistent after conversion.
+//                  Additions saturate at infinity, so "unreached"
+//                  never wraps around into a small cost.
+//
+//                  Queue is the open list (see PriorityQueues.h), a
+//                  binary heap by default. The radix heap and bucket
+//                  queue are faster on large maps but cannot take a
+//                  key below the last one popped, which only an
+//                  inconsistent heuristic produces: debug builds
+//                  assert on it, and release builds quietly raise
+//                  the key, so the path found may not be the
+//                  cheapest. Only pick them when the heuristic is
+//                  consistent by construction. RecordDistance is,
+//                  with a scale no larger than consistentScale
+//                  (GraphLoader.h). QueueBench times the three
+//                  queues against each other.
+//
+//                  GraphType is the arc storage, a CompactGraph by
+//                  default. A PackedGraph (forward arcs only) also
+//                  works for the forward searches.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost = ArcType, class Queue = typename DefaultQueue<Cost>::Type,
+         class GraphType = CompactGraph<ArcType> >
+class AStarSearch {
+private:
+    typedef CostTraits<Cost> Traits;
+
+    static_assert( std::numeric_limits<Cost>::is_specialized, "Cost must be a numeric type" );
+    static_assert( std::numeric_limits<ArcType>::is_integer || !std::numeric_limits<Cost>::is_integer,
+                   "Fractional arc weights need a fractional Cost, or a fixed-point scale with an integer Cost type; "
+                   "truncating them would make the heuristic overestimate" );
+    static_assert( std::numeric_limits<Cost>::is_integer == false || std::numeric_limits<Cost>::is_signed == false
+                   || sizeof( Cost ) >= sizeof( ArcType ),
+                   "A signed integer Cost narrower than ArcType cannot hold every path cost" );
+
+    GraphType const & m_graph;
+
+// ----------------------------------------------------------------
+//  Description:    Best known cost and parent of every node, and
+//                  whether it has been expanded.
+// ----------------------------------------------------------------
+    std::vector<Cost> m_cost;
+    std::vector<int> m_parent;
+    std::vector<bool> m_closed;
+
+// ----------------------------------------------------------------
+//  Description:    Marks the goals of a multi-goal query.
+// ----------------------------------------------------------------
+    std::vector<bool> m_goal;
+
+// ----------------------------------------------------------------
+//  Description:    Nodes whose entries must be reset before the
+//                  next query.
+// ----------------------------------------------------------------
+    std::vector<int> m_touched;
+
+    Queue m_queue;
+    double m_scale;
+    int m_expanded;
+
+    void reset();
+
+    // Whether node is an id of the graph and still in it.
+    bool valid( int node ) const {
+        return node >= 0 && node < m_graph.size() && m_graph.present( node );
+    }
+
+    void open( int node, Cost g, Cost h );
+    template<bool Reverse, class Heuristic, class IsGoal, class Observer>
+    int search( Heuristic& heuristic, IsGoal isGoal, Observer& observer );
+
+public:
+    typedef Cost CostType;
+
+    explicit AStarSearch( GraphType const & graph, double scale = 1.0 )
+        : m_graph( graph ), m_scale( scale ), m_expanded( 0 ) {}
+
+    // Accessors
+    Cost cost( int node ) const {
+        return m_cost[node];
+    }
+
+    int parent( int node ) const {
+        return m_parent[node];
+    }
+
+    int expanded() const {
+        return m_expanded;
+    }
+
+    double scale() const {
+        return m_scale;
+    }
+
+    // Bytes held by the per-query arrays.
+    size_t scratchBytes() const {
+        return m_cost.capacity() * sizeof( Cost ) + m_parent.capacity() * sizeof( int )
+             + m_closed.capacity() / 8 + m_touched.capacity() * sizeof( int ) + m_queue.bytes();
+    }
+
+    template<class Heuristic>
+    bool run( int start, int goal, Heuristic heuristic, std::vector<int>& path ) {
+        NullSearchObserver observer;
+        return run( start, goal, heuristic, path, observer );
+    }
+
+    template<class Heuristic, class Observer>
+    bool run( int start, int goal, Heuristic heuristic, std::vector<int>& path, Observer& observer );
+    template<class Heuristic>
+    bool run( int start, std::vector<int> const & goals, Heuristic heuristic, std::vector<int>& path );
+    template<class Heuristic>
+    bool runFromGoals( std::vector<int> const & goals, int start, Heuristic heuristic, std::vector<int>& path );
+};
+
+// ----------------------------------------------------------------
+//  Name:           NearestGoalHeuristic
+//  Description:    Heuristic for a multi-goal search: the smallest
+//                  of the estimates to each goal. It is consistent
+//                  as long as the estimate to each goal is. Each
+//                  call looks at every goal, so with many goals
+//                  runFromGoals is cheaper.
+//                  estimate( node, goal ) gives the estimate
+//                  between two nodes.
+// ----------------------------------------------------------------
+template<class Estimate>
+struct NearestGoalHeuristic {
+    std::vector<int> const & m_goals;
+    Estimate m_estimate;
+
+    NearestGoalHeuristic( std::vector<int> const & goals, Estimate estimate )
+        : m_goals( goals ), m_estimate( estimate ) {}
+
+    double operator()( int node ) {
+        double best = std::numeric_limits<double>::infinity();
+        for( int i = 0; i < (int)m_goals.size(); i++ ) {
+            double h = m_estimate( node, m_goals[i] );
+            if( h < best ) {
+                best = h;
+            }
+        }
+        return m_goals.empty() ? 0.0 : best;
+    }
+};
+
+template<class Estimate>
+NearestGoalHeuristic<Estimate> nearestGoalHeuristic( std::vector<int> const & goals, Estimate estimate ) {
+    return NearestGoalHeuristic<Estimate>( goals, estimate );
+}
+
+// ----------------------------------------------------------------
+//  Name:           reset
+//  Description:    Sizes the arrays to the graph and clears the
+//                  entries the last query touched.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue, class GraphType>
+void AStarSearch<ArcType, Cost, Queue, GraphType>::reset() {
+    if( (int)m_cost.size() != m_graph.size() ) {
+        m_cost.assign( m_graph.size(), Traits::infinity() );
+        m_parent.assign( m_graph.size(), -1 );
+        m_closed.assign( m_graph.size(), false );
+        m_goal.assign( m_graph.size(), false );
+    }
+    else {
+        for( int i = 0; i < (int)m_touched.size(); i++ ) {
+            m_cost[m_touched[i]] = Traits::infinity();
+            m_parent[m_touched[i]] = -1;
+            m_closed[m_touched[i]] = false;
+        }
+    }
+    m_touched.clear();
+    m_queue.clear();
+    m_expanded = 0;
+}
+
+// ----------------------------------------------------------------
+//  Name:           open
+//  Description:    Records a cost for a node and queues it.
+//  Arguments:      The node, its cost and its heuristic value, both
+//                  already converted to Cost.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue, class GraphType>
+void AStarSearch<ArcType, Cost, Queue, GraphType>::open( int node, Cost g, Cost h ) {
+    if( Traits::isInfinite( m_cost[node] ) ) {
+        m_touched.push_back( node );
+    }
+    m_cost[node] = g;
+    m_queue.push( Traits::add( g, h ), node );
+}
+
+// ----------------------------------------------------------------
+//  Name:           search
+//  Description:    The search loop shared by every query, run once
+//                  the queue holds the starting nodes. Stale queue
+//                  entries (for nodes that were pushed again with a
+//                  lower cost) are skipped when popped, and expanded
+//                  nodes are never expanded again. With Reverse set
+//                  the arcs are followed backwards, so m_parent
+//                  holds the next node towards the nearest start.
+//  Arguments:      The heuristic, the test for a goal node and the
+//                  observer to tell of each expansion.
+//  Return Value:   The goal reached, or -1.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue, class GraphType>
+template<bool Reverse, class Heuristic, class IsGoal, class Observer>
+int AStarSearch<ArcType, Cost, Queue, GraphType>::search( Heuristic& heuristic, IsGoal isGoal, Observer& observer ) {
+    while( !m_queue.empty() ) {
+        Cost f;
+        int node = m_queue.pop( f );
+
+        if( m_closed[node] ) {
+            continue;
+        }
+        m_closed[node] = true;
+        m_expanded++;
+        observer.expand( node, m_cost[node] );
+
+        if( isGoal( node ) ) {
+            return node;
+        }
+
+        typedef ArcDirection<Reverse> Direction;
+        int end = Direction::end( m_graph, node );
+        for( int a = Direction::begin( m_graph, node ); a < end; a++ ) {
+            int child = Direction::node( m_graph, a );
+            if( m_closed[child] ) {
+                continue;
+            }
+            ArcType weight = Direction::weight( m_graph, a );
+            if( CostTraits<ArcType>::isInfinite( weight ) ) {
+                continue;   // closed to this query (see WeightProfiles)
+            }
+            Cost g = Traits::add( m_cost[node], Traits::fromWeight( weight * m_scale ) );
+            if( g < m_cost[child] ) {
+                m_parent[child] = node;
+                open( child, g, Traits::fromHeuristic( heuristic( child ) * m_scale ) );
+            }
+        }
+    }
+    return -1;
+}
+
+// ----------------------------------------------------------------
+//  Name:           run
+//  Description:    Finds the cheapest path from start to goal.
+//  Arguments:      The start and goal node, the heuristic (called
+//                  as heuristic( node ), returning a consistent
+//                  estimate of the remaining cost in arc weight
+//                  units), the path to fill in, start first, and
+//                  the observer.
+//  Return Value:   true if the goal was reached.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue, class GraphType>
+template<class Heuristic, class Observer>
+bool AStarSearch<ArcType, Cost, Queue, GraphType>::run( int start, int goal, Heuristic heuristic, std::vector<int>& path, Observer& observer ) {
+    reset();
+    path.clear();
+    if( !valid( start ) || !valid( goal ) ) {
+        return false;
+    }
+
+    open( start, Traits::zero(), Traits::fromHeuristic( heuristic( start ) * m_scale ) );
+    if( search<false>( heuristic, [goal]( int node ) { return node == goal; }, observer ) < 0 ) {
+        return false;
+    }
+    for( int at = goal; at != -1; at = m_parent[at] ) {
+        path.push_back( at );
+    }
+    std::reverse( path.begin(), path.end() );
+    return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           run
+//  Description:    Finds the cheapest path from start to whichever
+//                  of the goals is nearest, in one search rather
+//                  than one per goal. The search stops at the first
+//                  goal expanded; with a consistent heuristic (see
+//                  NearestGoalHeuristic) no other goal is closer.
+//  Arguments:      The start, the goals, the heuristic (a consistent
+//                  estimate of the cost to the nearest goal) and the
+//                  path to fill in, start first, ending at the goal
+//                  reached. Goals that are not nodes of the graph
+//                  are skipped, as runFromGoals does.
+//  Return Value:   true if any goal was reached.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue, class GraphType>
+template<class Heuristic>
+bool AStarSearch<ArcType, Cost, Queue, GraphType>::run( int start, std::vector<int> const & goals, Heuristic heuristic, std::vector<int>& path ) {
+    reset();
+    path.clear();
+    if( !valid( start ) ) {
+        return false;
+    }
+    for( int i = 0; i < (int)goals.size(); i++ ) {
+        if( valid( goals[i] ) ) {
+            m_goal[goals[i]] = true;
+        }
+    }
+
+    open( start, Traits::zero(), Traits::fromHeuristic( heuristic( start ) * m_scale ) );
+    std::vector<bool> const & isGoal = m_goal;
+    NullSearchObserver observer;
+    int goal = search<false>( heuristic, [&isGoal]( int node ) { return isGoal[node]; }, observer );
+
+    for( int i = 0; i < (int)goals.size(); i++ ) {
+        if( valid( goals[i] ) ) {
+            m_goal[goals[i]] = false;
+        }
+    }
+    if( goal < 0 ) {
+        return false;
+    }
+    for( int at = goal; at != -1; at = m_parent[at] ) {
+        path.push_back( at );
+    }
+    std::reverse( path.begin(), path.end() );
+    return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           runFromGoals
+//  Description:    The same query answered backwards: every goal is
+//                  queued at cost zero and the search follows arcs
+//                  in reverse until it reaches start. The cost of
+//                  the search does not grow with the number of
+//                  goals, which suits large goal sets. Afterwards
+//                  cost( n ) is the cost from n to its nearest goal
+//                  for every expanded node.
+//  Arguments:      The goals, the start, the heuristic (a
+//                  consistent estimate of the cost from start to
+//                  the node, 0 for plain Dijkstra) and the path to
+//                  fill in, start first. Goals that are not nodes
+//                  of the graph are skipped.
+//  Return Value:   true if any goal can be reached from start.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue, class GraphType>
+template<class Heuristic>
+bool AStarSearch<ArcType, Cost, Queue, GraphType>::runFromGoals( std::vector<int> const & goals, int start, Heuristic heuristic, std::vector<int>& path ) {
+    reset();
+    path.clear();
+    if( !valid( start ) ) {
+        return false;
+    }
+    for( int i = 0; i < (int)goals.size(); i++ ) {
+        if( valid( goals[i] ) && Traits::isInfinite( m_cost[goals[i]] ) ) {
+            open( goals[i], Traits::zero(), Traits::fromHeuristic( heuristic( goals[i] ) * m_scale ) );
+        }
+    }
+
+    NullSearchObserver observer;
+    if( search<true>( heuristic, [start]( int node ) { return node == start; }, observer ) < 0 ) {
+        return false;
+    }
+    // parents point away from start, towards the goal.
+    for( int at = start; at != -1; at = m_parent[at] ) {
+        path.push_back( at );
+    }
+    return true;
+}
+
+#endif
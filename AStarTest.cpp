@@ -0,0 +1,202 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+
+//sfml includes
+#ifdef _DEBUG
+#pragma comment(lib,"sfml-graphics-d.lib")
+#pragma comment(lib,"sfml-system-d.lib")
+#pragma comment(lib,"sfml-window-d.lib")
+#else
+#pragma comment(lib,"sfml-graphics.lib")
+#pragma comment(lib,"sfml-system.lib")
+#pragma comment(lib,"sfml-window.lib")
+#endif
+
+#include "SFML/Graphics.hpp"
+
+//standard c++ includes
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include "Graph.h"
+
+using namespace std;
+
+typedef Graph<tuple<string, int, int>, int> TestGraph;
+typedef GraphNode<tuple<string, int, int>, int> Node;
+
+// The kinds of h(n) each query is run with
+////////////////////////////
+enum HeuristicKind { H_ZERO, H_CONSISTENT, H_INCONSISTENT, H_KINDS };
+const char* const kindNames[H_KINDS] = { "zero", "consistent", "inconsistent" };
+
+// Counts how often each node is expanded
+////////////////////////////
+struct ExpansionCounter : NullVisitor {
+	vector<int>& m_expanded;
+
+	ExpansionCounter(vector<int>& expanded) : m_expanded(expanded) {}
+
+	void expand(Node * pNode) {
+		m_expanded[pNode->index()]++;
+	}
+};
+
+////////////////////////////////////////////////////////////
+/// Shortest distances from one node (or, with reverse set, to it)
+/// by a plain O(n^2) Dijkstra over the arc lists. Unreached nodes
+/// are left at unreached.
+////////////////////////////////////////////////////////////
+const int unreached = 1 << 29;
+
+vector<int> dijkstra(TestGraph& graph, int size, int source, bool reverse)
+{
+	vector<int> distance(size, unreached);
+	vector<bool> done(size, false);
+	distance[source] = 0;
+	for (int step = 0; step < size; step++)
+	{
+		int best = -1;
+		for (int i = 0; i < size; i++)
+			if (!done[i] && (best < 0 || distance[i] < distance[best]))
+				best = i;
+		if (best < 0 || distance[best] == unreached)
+			break;
+		done[best] = true;
+
+		for (int from = 0; from < size; from++)
+		{
+			list<GraphArc<tuple<string, int, int>, int> > const & arcs = graph.nodeArray()[from]->arcList();
+			for (auto iter = arcs.begin(); iter != arcs.end(); iter++)
+			{
+				int to = iter->node()->index();
+				if (!reverse && from == best && distance[best] + iter->weight() < distance[to])
+					distance[to] = distance[best] + iter->weight();
+				if (reverse && to == best && distance[best] + iter->weight() < distance[from])
+					distance[from] = distance[best] + iter->weight();
+			}
+		}
+	}
+	return distance;
+}
+
+int pathCost(TestGraph& graph, vector<Node *> const & path)
+{
+	int cost = 0;
+	for (size_t i = 1; i < path.size(); i++)
+		cost += graph.getArc(path[i - 1]->index(), path[i]->index())->weight();
+	return cost;
+}
+
+////////////////////////////////////////////////////////////
+/// Entry point of application
+//
+// AStarTest [graphs] [seed]
+//
+// Checks Graph::aStar on random graphs. Each graph gets a few random
+// queries, and each query is run with three heuristics: zero, the
+// straight line distance rounded down (arc weights are at least the
+// distance rounded up, so it is consistent), and a random fraction of
+// the true distance to the goal per node, which never overestimates
+// but is usually inconsistent. Every path must cost what Dijkstra
+// says, and with the first two heuristics no node may be expanded
+// twice. Returns 1 if any check fails; the same seed always builds
+// the same graphs.
+////////////////////////////////////////////////////////////
+int main(int argc, char *argv[])
+{
+	int graphs = argc > 1 ? atoi(argv[1]) : 3000;
+	unsigned seed = argc > 2 ? (unsigned)atoi(argv[2]) : 46;
+	srand(seed);
+
+	int failures = 0;
+	long expansions[H_KINDS] = { 0, 0, 0 };
+	long reexpansions[H_KINDS] = { 0, 0, 0 };
+	sf::Font font;
+
+	for (int trial = 0; trial < graphs; trial++)
+	{
+		int size = 2 + rand() % 40;
+		TestGraph graph(size);
+		vector<sf::Vector2f> position(size);
+		for (int i = 0; i < size; i++)
+		{
+			position[i] = sf::Vector2f((float)(rand() % 100), (float)(rand() % 100));
+			graph.addNode(make_tuple(string("n"), 0, 0), i, position[i], font);
+		}
+		auto distance = [&](int from, int to) {
+			float dx = position[from].x - position[to].x;
+			float dy = position[from].y - position[to].y;
+			return sqrt(dx * dx + dy * dy);
+		};
+		int arcs = rand() % (size * 4 + 1);
+		for (int i = 0; i < arcs; i++)
+		{
+			int from = rand() % size;
+			int to = rand() % size;
+			if (from != to && graph.getArc(from, to) == 0)
+				graph.addArc(from, to, (int)ceil(distance(from, to)) + rand() % 20);
+		}
+
+		for (int query = 0; query < 3; query++)
+		{
+			int start = rand() % size;
+			int goal = rand() % size;
+			vector<int> fromStart = dijkstra(graph, size, start, false);
+			vector<int> toGoal = dijkstra(graph, size, goal, true);
+
+			for (int kind = 0; kind < H_KINDS; kind++)
+			{
+				for (int i = 0; i < size; i++)
+				{
+					int h = 0;
+					if (kind == H_CONSISTENT)
+						h = (int)floor(distance(i, goal));
+					else if (kind == H_INCONSISTENT && toGoal[i] != unreached)
+						h = toGoal[i] * (rand() % 101) / 100;
+					Node * pNode = graph.nodeArray()[i];
+					pNode->Reset();
+					pNode->setData(make_tuple(string("n"), CostTraits<int>::infinity(), h));
+				}
+
+				vector<int> expanded(size, 0);
+				vector<Node *> path;
+				graph.aStar(graph.nodeArray()[start], graph.nodeArray()[goal], path, ExpansionCounter(expanded));
+
+				bool reachable = fromStart[goal] != unreached;
+				bool ok = reachable != path.empty();
+				if (ok && reachable)
+					ok = path.front()->index() == start && path.back()->index() == goal && pathCost(graph, path) == fromStart[goal];
+
+				int twice = 0;
+				for (int i = 0; i < size; i++)
+				{
+					expansions[kind] += expanded[i];
+					if (expanded[i] > 1)
+						twice += expanded[i] - 1;
+				}
+				reexpansions[kind] += twice;
+				if (kind != H_INCONSISTENT && twice > 0)
+					ok = false;
+
+				if (!ok)
+				{
+					failures++;
+					cout << "graph " << trial << " query " << start << " -> " << goal << " with " << kindNames[kind] << " h: "
+						<< (path.empty() ? "no path" : "cost " + to_string(pathCost(graph, path)))
+						<< ", Dijkstra " << (reachable ? to_string(fromStart[goal]) : string("no path"))
+						<< ", " << twice << " re-expansions" << endl;
+				}
+			}
+		}
+	}
+
+	for (int kind = 0; kind < H_KINDS; kind++)
+		cout << kindNames[kind] << " h: " << expansions[kind] << " expansions, " << reexpansions[kind] << " re-expansions" << endl;
+	cout << graphs << " graphs, " << failures << " failures" << endl;
+	return failures == 0 ? 0 : 1;
+}
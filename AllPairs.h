@@ -0,0 +1,323 @@
+#ifndef ALLPAIRS_H
+#define ALLPAIRS_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "CompactGraph.h"
+#include "Parallel.h"
+
+#if defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) || defined( __SSE2__ )
+#include <emmintrin.h>
+#define ALLPAIRS_SSE2
+#endif
+
+// ----------------------------------------------------------------
+//  Name:           MinPlusKernel
+//  Description:    The inner step of Floyd-Warshall on one row of a
+//                  block: for every j,
+//                      if( dik + b[j] < c[j] ) c[j] = dik + b[j], n[j] = nik
+//                  with the comparison done as a mask, so there is
+//                  no branch per entry. The int and float versions
+//                  work four entries at a time with SSE2; any other
+//                  weight type (and any build without SSE2) uses the
+//                  plain loop, which compilers can often vectorize
+//                  themselves. count must be a multiple of four.
+// ----------------------------------------------------------------
+template<class Weight>
+struct MinPlusKernel {
+    static void relax( Weight* c, int* n, const Weight* b, Weight dik, int nik, int count ) {
+        for( int j = 0; j < count; j++ ) {
+            Weight d = dik + b[j];
+            bool better = d < c[j];
+            c[j] = better ? d : c[j];
+            n[j] = better ? nik : n[j];
+        }
+    }
+};
+
+#ifdef ALLPAIRS_SSE2
+template<>
+struct MinPlusKernel<int> {
+    static void relax( int* c, int* n, const int* b, int dik, int nik, int count ) {
+        __m128i d4 = _mm_set1_epi32( dik );
+        __m128i n4 = _mm_set1_epi32( nik );
+        for( int j = 0; j < count; j += 4 ) {
+            __m128i d = _mm_add_epi32( d4, _mm_loadu_si128( (const __m128i*)( b + j ) ) );
+            __m128i old = _mm_loadu_si128( (const __m128i*)( c + j ) );
+            __m128i better = _mm_cmplt_epi32( d, old );
+            _mm_storeu_si128( (__m128i*)( c + j ), _mm_or_si128( _mm_and_si128( better, d ), _mm_andnot_si128( better, old ) ) );
+            __m128i next = _mm_loadu_si128( (const __m128i*)( n + j ) );
+            _mm_storeu_si128( (__m128i*)( n + j ), _mm_or_si128( _mm_and_si128( better, n4 ), _mm_andnot_si128( better, next ) ) );
+        }
+    }
+};
+
+template<>
+struct MinPlusKernel<float> {
+    static void relax( float* c, int* n, const float* b, float dik, int nik, int count ) {
+        __m128 d4 = _mm_set1_ps( dik );
+        __m128i n4 = _mm_set1_epi32( nik );
+        for( int j = 0; j < count; j += 4 ) {
+            __m128 d = _mm_add_ps( d4, _mm_loadu_ps( b + j ) );
+            __m128 old = _mm_loadu_ps( c + j );
+            __m128 better = _mm_cmplt_ps( d, old );
+            _mm_storeu_ps( c + j, _mm_min_ps( d, old ) );
+            __m128i mask = _mm_castps_si128( better );
+            __m128i next = _mm_loadu_si128( (const __m128i*)( n + j ) );
+            _mm_storeu_si128( (__m128i*)( n + j ), _mm_or_si128( _mm_and_si128( mask, n4 ), _mm_andnot_si128( mask, next ) ) );
+        }
+    }
+};
+#endif
+
+// ----------------------------------------------------------------
+//  Name:           AllPairsTable
+//  Description:    Shortest distances between every pair of nodes of
+//                  a small graph (or of a set of its nodes, such as
+//                  a room or a cluster), with a next-hop table to
+//                  rebuild the paths, worked out by Floyd-Warshall
+//                  on a dense matrix.
+//
+//                  The matrix is cut into BLOCK x BLOCK tiles and
+//                  solved a band of BLOCK pivots at a time: first
+//                  the tile on the diagonal, then the other tiles in
+//                  its row and column, then all remaining tiles, the
+//                  last two steps spread across threads. Three tiles
+//                  fit in cache together, so each tile is loaded
+//                  once per band rather than once per pivot, and the
+//                  rows are relaxed with MinPlusKernel.
+//
+//                  The work grows as size cubed. On one core (SSE2,
+//                  -O2, random graph of three arcs per node) 2000
+//                  nodes take about 2.2 s and 4000 nodes about 13 to
+//                  18 s. That is not "a few seconds" for 4000 nodes.
+//                  Only the last two steps of each band run in
+//                  parallel, so more cores can cut that time by at
+//                  most their number. The multi-core time has not
+//                  been measured.
+//
+//                  Memory is (size rounded up to BLOCK) squared
+//                  times sizeof( Weight ) + 4, about 128 MB for 4000
+//                  nodes with int weights. Weights must not be
+//                  negative, and with an integer Weight every path
+//                  cost must stay below half its largest value.
+// ----------------------------------------------------------------
+template<class Weight>
+class AllPairsTable {
+private:
+    enum { BLOCK = 64 };
+
+// ----------------------------------------------------------------
+//  Description:    The graph node of each row, and the row of each
+//                  graph node (-1 for nodes not in the table).
+// ----------------------------------------------------------------
+    std::vector<int> m_nodes;
+    std::vector<int> m_rows;
+
+// ----------------------------------------------------------------
+//  Description:    Distance and next row from row i to row j, at
+//                  [i * m_stride + j]. The padding rows and columns
+//                  stay unreached.
+// ----------------------------------------------------------------
+    int m_stride;
+    std::vector<Weight> m_distance;
+    std::vector<int> m_next;
+
+    static Weight unreached() {
+        return std::numeric_limits<Weight>::has_infinity ? std::numeric_limits<Weight>::infinity()
+                                                         : std::numeric_limits<Weight>::max() / 2;
+    }
+
+    void relaxTile( int ti, int tj, int tk );
+    void solve( int threads );
+
+public:
+    AllPairsTable() : m_stride( 0 ) {}
+
+    template<class ArcType>
+    void build( CompactGraph<ArcType> const & graph, std::vector<int> const & nodes, int threads = 0 );
+    template<class ArcType>
+    void build( CompactGraph<ArcType> const & graph, int threads = 0 );
+
+    // Accessors
+    int size() const {
+        return (int)m_nodes.size();
+    }
+
+    bool contains( int node ) const {
+        return node >= 0 && node < (int)m_rows.size() && m_rows[node] >= 0;
+    }
+
+    bool reachable( int from, int to ) const {
+        return m_distance[m_rows[from] * m_stride + m_rows[to]] < unreached();
+    }
+
+    // Distance between two nodes of the table, or infinity() (max() for
+    // integer weights) if there is no path inside it.
+    Weight distance( int from, int to ) const {
+        Weight d = m_distance[m_rows[from] * m_stride + m_rows[to]];
+        return d < unreached() ? d : ( std::numeric_limits<Weight>::has_infinity ? d : std::numeric_limits<Weight>::max() );
+    }
+
+    // The node after from on a shortest path to to, or -1.
+    int nextHop( int from, int to ) const {
+        return reachable( from, to ) ? m_nodes[m_next[m_rows[from] * m_stride + m_rows[to]]] : -1;
+    }
+
+    size_t bytes() const {
+        return m_distance.capacity() * sizeof( Weight ) + m_next.capacity() * sizeof( int )
+             + ( m_nodes.capacity() + m_rows.capacity() ) * sizeof( int );
+    }
+
+    bool path( int from, int to, std::vector<int>& path ) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Fills in the table for some nodes of a graph.
+//                  Only arcs between those nodes are used, so the
+//                  paths stay inside the set; with parallel arcs the
+//                  cheapest counts.
+//  Arguments:      The graph, the nodes (each once) and the number
+//                  of threads (0 for all cores).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Weight>
+template<class ArcType>
+void AllPairsTable<Weight>::build( CompactGraph<ArcType> const & graph, std::vector<int> const & nodes, int threads ) {
+    int n = (int)nodes.size();
+    m_nodes = nodes;
+    m_rows.assign( graph.size(), -1 );
+    for( int i = 0; i < n; i++ ) {
+        m_rows[nodes[i]] = i;
+    }
+
+    m_stride = ( n + BLOCK - 1 ) / BLOCK * BLOCK;
+    m_distance.assign( (size_t)m_stride * m_stride, unreached() );
+    m_next.assign( (size_t)m_stride * m_stride, -1 );
+    for( int i = 0; i < n; i++ ) {
+        size_t row = (size_t)i * m_stride;
+        m_distance[row + i] = Weight( 0 );
+        m_next[row + i] = i;
+        for( int a = graph.begin( nodes[i] ); a < graph.end( nodes[i] ); a++ ) {
+            int j = m_rows[graph.target( a )];
+            Weight weight = Weight( graph.weight( a ) );
+            if( j >= 0 && weight < m_distance[row + j] ) {
+                m_distance[row + j] = weight;
+                m_next[row + j] = j;
+            }
+        }
+    }
+    solve( threads );
+}
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Fills in the table for every node of a graph.
+//  Arguments:      The graph and the number of threads.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Weight>
+template<class ArcType>
+void AllPairsTable<Weight>::build( CompactGraph<ArcType> const & graph, int threads ) {
+    std::vector<int> nodes;
+    for( int i = 0; i < graph.size(); i++ ) {
+        if( graph.present( i ) ) {
+            nodes.push_back( i );
+        }
+    }
+    build( graph, nodes, threads );
+}
+
+// ----------------------------------------------------------------
+//  Name:           relaxTile
+//  Description:    Relaxes tile (ti, tj) through each pivot of band
+//                  tk: d[i][j] = min( d[i][j], d[i][k] + d[k][j] ).
+//  Arguments:      The tile's row and column and the pivot band.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Weight>
+void AllPairsTable<Weight>::relaxTile( int ti, int tj, int tk ) {
+    Weight* distance = &m_distance[0];
+    int* next = &m_next[0];
+    for( int k = tk * BLOCK; k < ( tk + 1 ) * BLOCK; k++ ) {
+        const Weight* rowK = distance + (size_t)k * m_stride + tj * BLOCK;
+        for( int i = ti * BLOCK; i < ( ti + 1 ) * BLOCK; i++ ) {
+            size_t row = (size_t)i * m_stride;
+            Weight dik = distance[row + k];
+            if( !( dik < unreached() ) ) {
+                continue;
+            }
+            MinPlusKernel<Weight>::relax( distance + row + tj * BLOCK, next + row + tj * BLOCK, rowK, dik, next[row + k], BLOCK );
+        }
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           solve
+//  Description:    Blocked Floyd-Warshall over the whole matrix.
+//  Arguments:      The number of threads.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Weight>
+void AllPairsTable<Weight>::solve( int threads ) {
+    int tiles = m_stride / BLOCK;
+    AllPairsTable& self = *this;
+    for( int tk = 0; tk < tiles; tk++ ) {
+        // the diagonal tile depends only on itself.
+        relaxTile( tk, tk, tk );
+
+        // its row and column need only it.
+        parallelFor( 0, 2 * tiles, [&]( int lo, int hi, int ) {
+            for( int t = lo; t < hi; t++ ) {
+                int other = t / 2;
+                if( other == tk ) {
+                    continue;
+                }
+                if( t % 2 == 0 ) {
+                    self.relaxTile( tk, other, tk );
+                }
+                else {
+                    self.relaxTile( other, tk, tk );
+                }
+            }
+        }, threads, 2 );
+
+        // every other tile needs its row's and column's.
+        parallelFor( 0, tiles * tiles, [&]( int lo, int hi, int ) {
+            for( int t = lo; t < hi; t++ ) {
+                int ti = t / tiles;
+                int tj = t % tiles;
+                if( ti != tk && tj != tk ) {
+                    self.relaxTile( ti, tj, tk );
+                }
+            }
+        }, threads, 1 );
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           path
+//  Description:    Rebuilds a shortest path from the next-hop table.
+//  Arguments:      The two nodes and the path to fill in, from
+//                  first.
+//  Return Value:   false if there is no path inside the table.
+// ----------------------------------------------------------------
+template<class Weight>
+bool AllPairsTable<Weight>::path( int from, int to, std::vector<int>& path ) const {
+    path.clear();
+    if( !contains( from ) || !contains( to ) || !reachable( from, to ) ) {
+        return false;
+    }
+    int at = m_rows[from];
+    int goal = m_rows[to];
+    path.push_back( from );
+    while( at != goal && (int)path.size() <= size() ) {
+        at = m_next[(size_t)at * m_stride + goal];
+        path.push_back( m_nodes[at] );
+    }
+    return at == goal;
+}
+
+#endif
@@ -0,0 +1,462 @@
+#ifndef ALTERNATIVEROUTES_H
+#define ALTERNATIVEROUTES_H
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "CompactGraph.h"
+#include "CostTraits.h"
+#include "AStarSearch.h"
+
+// ----------------------------------------------------------------
+//  Name:           AdjustableGraph
+//  Description:    A CompactGraph whose forward arc weights can be
+//                  changed for a while and then put back: the view
+//                  AlternativeRoutes searches on. block() gives an
+//                  arc an infinite weight, which AStarSearch treats
+//                  as closed. restore() only resets the arcs that
+//                  were changed, so a change costs nothing per query
+//                  beyond the arcs it touches.
+// ----------------------------------------------------------------
+template<class ArcType>
+class AdjustableGraph {
+private:
+    CompactGraph<ArcType> const & m_graph;
+    std::vector<ArcType> m_weights;
+    std::vector<bool> m_changed;
+    std::vector<int> m_touched;
+
+public:
+    explicit AdjustableGraph( CompactGraph<ArcType> const & graph )
+        : m_graph( graph ), m_changed( graph.arcCount(), false ) {
+        m_weights.reserve( graph.arcCount() );
+        for( int a = 0; a < graph.arcCount(); a++ ) {
+            m_weights.push_back( graph.weight( a ) );
+        }
+    }
+
+    // Accessors
+    CompactGraph<ArcType> const & base() const {
+        return m_graph;
+    }
+
+    int size() const {
+        return m_graph.size();
+    }
+
+    int arcCount() const {
+        return m_graph.arcCount();
+    }
+
+    bool present( int node ) const {
+        return m_graph.present( node );
+    }
+
+    int begin( int node ) const {
+        return m_graph.begin( node );
+    }
+
+    int end( int node ) const {
+        return m_graph.end( node );
+    }
+
+    int target( int arc ) const {
+        return m_graph.target( arc );
+    }
+
+    ArcType weight( int arc ) const {
+        return m_weights[arc];
+    }
+
+    int degree( int node ) const {
+        return m_graph.degree( node );
+    }
+
+    void setWeight( int arc, ArcType weight ) {
+        if( !m_changed[arc] ) {
+            m_changed[arc] = true;
+            m_touched.push_back( arc );
+        }
+        m_weights[arc] = weight;
+    }
+
+    void block( int arc ) {
+        setWeight( arc, CostTraits<ArcType>::infinity() );
+    }
+
+    void restore() {
+        for( int i = 0; i < (int)m_touched.size(); i++ ) {
+            m_weights[m_touched[i]] = m_graph.weight( m_touched[i] );
+            m_changed[m_touched[i]] = false;
+        }
+        m_touched.clear();
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           AlternativeRoutes
+//  Description:    Several routes between the same two nodes, for
+//                  offering choices or spreading agents out.
+//
+//                  kShortest gives the k cheapest loopless paths
+//                  (Yen's algorithm): each new path leaves one of
+//                  the last path's nodes (the spur) by an arc no
+//                  earlier path with the same start took there, and
+//                  the cheapest such detour is the next path. It is
+//                  exact. Rather than a blind search from every spur,
+//                  one reverse search from the goal first gives the
+//                  cheapest cost from each node to it: blocking arcs
+//                  only makes routes dearer, so that is a perfect
+//                  heuristic for the spur searches, and where the
+//                  blocking leaves a spur's own cheapest route open
+//                  it is the answer with no search at all.
+//
+//                  penalized is the faster heuristic: after each
+//                  search the arcs of the route found are made more
+//                  expensive, so the next search is pushed onto
+//                  other roads. A route is kept if little enough of
+//                  it is shared with the routes already kept. It
+//                  runs about one search per route.
+//
+//                  Both share one search and one adjustable copy of
+//                  the weights, reused from query to query. Paths
+//                  come back as node lists, start first, as from
+//                  AStarSearch, with their costs in Cost units. For
+//                  penalized, heuristic( node ) estimates the
+//                  remaining cost to the goal, as for AStarSearch;
+//                  raising weights keeps it consistent.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost = ArcType, class Queue = typename DefaultQueue<Cost>::Type>
+class AlternativeRoutes {
+private:
+    typedef CostTraits<Cost> Traits;
+
+    AdjustableGraph<ArcType> m_graph;
+    AStarSearch<ArcType, Cost, Queue, AdjustableGraph<ArcType> > m_search;
+
+// ----------------------------------------------------------------
+//  Description:    Candidate paths (Yen) and how often each arc
+//                  has been used by a kept route (penalized).
+// ----------------------------------------------------------------
+    std::vector< std::vector<int> > m_candidates;
+    std::vector<Cost> m_candidateCosts;
+    std::vector<int> m_used;
+    std::vector<int> m_path;
+    int m_searches;
+
+// ----------------------------------------------------------------
+//  Description:    Shortest path tree into the goal of a kShortest
+//                  query, by the graph's own weights: each node's
+//                  cost to the goal and the next node on the way
+//                  (-1 at the goal and where the goal is out of
+//                  reach).
+// ----------------------------------------------------------------
+    std::vector<Cost> m_toGoal;
+    std::vector<int> m_towards;
+    Queue m_queue;
+
+    int arcBetween( int from, int to ) const;
+    Cost pathCost( std::vector<int> const & path ) const;
+    void buildTree( int goal );
+    bool treePath( int from, std::vector<int>& path ) const;
+
+    // m_toGoal in arc weight units for AStarSearch, half a unit high
+    // for integer costs so scaling and rounding down gives it back.
+    double remaining( int node ) const {
+        if( Traits::isInfinite( m_toGoal[node] ) ) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return ( Traits::toDouble( m_toGoal[node] ) + ( std::numeric_limits<Cost>::is_integer ? 0.5 : 0.0 ) ) / m_search.scale();
+    }
+
+public:
+    explicit AlternativeRoutes( CompactGraph<ArcType> const & graph, double scale = 1.0 )
+        : m_graph( graph ), m_search( m_graph, scale ), m_searches( 0 ) {}
+
+    // Accessors
+    int searches() const {
+        return m_searches;
+    }
+
+    int kShortest( int start, int goal, int k, std::vector< std::vector<int> >& paths, std::vector<Cost>& costs );
+    template<class Heuristic>
+    int penalized( int start, int goal, int k, Heuristic heuristic,
+                   std::vector< std::vector<int> >& paths, std::vector<Cost>& costs,
+                   double penalty = 0.4, double maxShared = 0.7, int attempts = 0 );
+};
+
+// ----------------------------------------------------------------
+//  Name:           arcBetween
+//  Description:    The cheapest arc from one node to another, by
+//                  the graph's own weights.
+//  Arguments:      The two nodes.
+//  Return Value:   The arc id, or -1 if there is none.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+int AlternativeRoutes<ArcType, Cost, Queue>::arcBetween( int from, int to ) const {
+    CompactGraph<ArcType> const & graph = m_graph.base();
+    int best = -1;
+    for( int a = graph.begin( from ); a < graph.end( from ); a++ ) {
+        if( graph.target( a ) == to && ( best < 0 || graph.weight( a ) < graph.weight( best ) ) ) {
+            best = a;
+        }
+    }
+    return best;
+}
+
+// ----------------------------------------------------------------
+//  Name:           pathCost
+//  Description:    The cost of a path by the graph's own weights,
+//                  converted and added the way AStarSearch does.
+//  Arguments:      The path.
+//  Return Value:   The cost.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+Cost AlternativeRoutes<ArcType, Cost, Queue>::pathCost( std::vector<int> const & path ) const {
+    Cost cost = Traits::zero();
+    for( int i = 0; i + 1 < (int)path.size(); i++ ) {
+        int arc = arcBetween( path[i], path[i + 1] );
+        cost = Traits::add( cost, Traits::fromWeight( m_graph.base().weight( arc ) * m_search.scale() ) );
+    }
+    return cost;
+}
+
+// ----------------------------------------------------------------
+//  Name:           buildTree
+//  Description:    Dijkstra over the reverse arcs from the goal, to
+//                  every node that can reach it.
+//  Arguments:      The goal.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+void AlternativeRoutes<ArcType, Cost, Queue>::buildTree( int goal ) {
+    CompactGraph<ArcType> const & graph = m_graph.base();
+    m_toGoal.assign( graph.size(), Traits::infinity() );
+    m_towards.assign( graph.size(), -1 );
+    m_queue.clear();
+    m_toGoal[goal] = Traits::zero();
+    m_queue.push( Traits::zero(), goal );
+
+    while( !m_queue.empty() ) {
+        Cost key;
+        int node = m_queue.pop( key );
+        if( m_toGoal[node] < key ) {
+            continue;
+        }
+        for( int a = graph.rbegin( node ); a < graph.rend( node ); a++ ) {
+            ArcType weight = graph.rweight( a );
+            if( CostTraits<ArcType>::isInfinite( weight ) ) {
+                continue;
+            }
+            int source = graph.source( a );
+            Cost c = Traits::add( m_toGoal[node], Traits::fromWeight( weight * m_search.scale() ) );
+            if( c < m_toGoal[source] ) {
+                m_toGoal[source] = c;
+                m_towards[source] = node;
+                m_queue.push( c, source );
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           treePath
+//  Description:    The tree's route from a node to the goal.
+//  Arguments:      The node and the path to fill in, node first.
+//  Return Value:   false if the goal is out of reach, or the route
+//                  uses an arc that is blocked at the moment.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+bool AlternativeRoutes<ArcType, Cost, Queue>::treePath( int from, std::vector<int>& path ) const {
+    path.clear();
+    if( Traits::isInfinite( m_toGoal[from] ) ) {
+        return false;
+    }
+    for( int at = from; at != -1; at = m_towards[at] ) {
+        path.push_back( at );
+        if( m_towards[at] != -1 && CostTraits<ArcType>::isInfinite( m_graph.weight( arcBetween( at, m_towards[at] ) ) ) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           kShortest
+//  Description:    Yen's k shortest loopless paths. searches() is
+//                  then the number of searches run, the reverse one
+//                  from the goal included; spurs answered straight
+//                  from the tree do not count.
+//  Arguments:      The start and goal, how many paths, and the
+//                  paths and costs to fill in, cheapest first.
+//  Return Value:   The number of paths found (fewer than k if there
+//                  are no more).
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+int AlternativeRoutes<ArcType, Cost, Queue>::kShortest( int start, int goal, int k,
+                                                        std::vector< std::vector<int> >& paths, std::vector<Cost>& costs ) {
+    paths.clear();
+    costs.clear();
+    m_candidates.clear();
+    m_candidateCosts.clear();
+    m_searches = 0;
+    if( k <= 0 || start < 0 || goal < 0 || start >= m_graph.size() || goal >= m_graph.size()
+        || !m_graph.present( start ) || !m_graph.present( goal ) ) {
+        return 0;
+    }
+
+    m_graph.restore();
+    m_searches++;
+    buildTree( goal );
+    if( !treePath( start, m_path ) ) {
+        return 0;
+    }
+    paths.push_back( m_path );
+    costs.push_back( m_toGoal[start] );
+    auto exact = [this]( int node ) { return remaining( node ); };
+
+    while( (int)paths.size() < k ) {
+        std::vector<int> const & last = paths.back();
+        for( int spur = 0; spur + 1 < (int)last.size(); spur++ ) {
+            // no path may leave the root the way a kept one did...
+            for( int p = 0; p < (int)paths.size(); p++ ) {
+                std::vector<int> const & path = paths[p];
+                if( (int)path.size() > spur + 1 && std::equal( last.begin(), last.begin() + spur + 1, path.begin() ) ) {
+                    for( int a = m_graph.begin( path[spur] ); a < m_graph.end( path[spur] ); a++ ) {
+                        if( m_graph.target( a ) == path[spur + 1] ) {
+                            m_graph.block( a );
+                        }
+                    }
+                }
+            }
+            // ...nor go back through the root.
+            for( int r = 0; r < spur; r++ ) {
+                for( int a = m_graph.begin( last[r] ); a < m_graph.end( last[r] ); a++ ) {
+                    m_graph.block( a );
+                }
+            }
+
+            // the tree's route is the cheapest there could be, so if it
+            // is still open it is the detour; otherwise search for one.
+            bool found = treePath( last[spur], m_path );
+            if( !found ) {
+                m_searches++;
+                found = m_search.run( last[spur], goal, exact, m_path );
+            }
+            m_graph.restore();
+            if( !found ) {
+                continue;
+            }
+
+            std::vector<int> candidate( last.begin(), last.begin() + spur );
+            candidate.insert( candidate.end(), m_path.begin(), m_path.end() );
+            bool known = false;
+            for( int c = 0; c < (int)m_candidates.size() && !known; c++ ) {
+                known = m_candidates[c] == candidate;
+            }
+            if( !known ) {
+                m_candidates.push_back( candidate );
+                m_candidateCosts.push_back( pathCost( candidate ) );
+            }
+        }
+
+        if( m_candidates.empty() ) {
+            break;
+        }
+        int best = 0;
+        for( int c = 1; c < (int)m_candidates.size(); c++ ) {
+            if( m_candidateCosts[c] < m_candidateCosts[best] ) {
+                best = c;
+            }
+        }
+        paths.push_back( std::vector<int>() );
+        paths.back().swap( m_candidates[best] );
+        costs.push_back( m_candidateCosts[best] );
+        m_candidates[best].swap( m_candidates.back() );
+        m_candidates.pop_back();
+        m_candidateCosts[best] = m_candidateCosts.back();
+        m_candidateCosts.pop_back();
+    }
+    return (int)paths.size();
+}
+
+// ----------------------------------------------------------------
+//  Name:           penalized
+//  Description:    Alternative routes by penalty. Each search's
+//                  route has its arcs' weights multiplied by
+//                  ( 1 + penalty ) for the searches after it. A
+//                  route is kept if at most maxShared of its cost
+//                  lies on arcs of routes already kept.
+//  Arguments:      The start and goal, how many routes, the
+//                  heuristic, the routes and their costs (by the
+//                  graph's real weights) to fill in, the penalty,
+//                  the largest shared part and the most searches
+//                  to try (0 for 3 * k).
+//  Return Value:   The number of routes found, the first always the
+//                  cheapest.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+template<class Heuristic>
+int AlternativeRoutes<ArcType, Cost, Queue>::penalized( int start, int goal, int k, Heuristic heuristic,
+                                                        std::vector< std::vector<int> >& paths, std::vector<Cost>& costs,
+                                                        double penalty, double maxShared, int attempts ) {
+    paths.clear();
+    costs.clear();
+    m_searches = 0;
+    m_graph.restore();
+    if( (int)m_used.size() != m_graph.arcCount() ) {
+        m_used.assign( m_graph.arcCount(), 0 );
+    }
+    if( attempts <= 0 ) {
+        attempts = 3 * k;
+    }
+
+    while( (int)paths.size() < k && m_searches < attempts ) {
+        m_searches++;
+        if( !m_search.run( start, goal, heuristic, m_path ) ) {
+            break;
+        }
+
+        // share of the route's cost already covered by kept routes.
+        double total = 0.0;
+        double shared = 0.0;
+        for( int i = 0; i + 1 < (int)m_path.size(); i++ ) {
+            int arc = arcBetween( m_path[i], m_path[i + 1] );
+            double weight = (double)m_graph.base().weight( arc );
+            total += weight;
+            if( m_used[arc] > 0 ) {
+                shared += weight;
+            }
+        }
+        if( paths.empty() || shared <= maxShared * total ) {
+            paths.push_back( m_path );
+            costs.push_back( pathCost( m_path ) );
+            for( int i = 0; i + 1 < (int)m_path.size(); i++ ) {
+                m_used[arcBetween( m_path[i], m_path[i + 1] )]++;
+            }
+        }
+
+        // make every arc of the route dearer, kept or not.
+        for( int i = 0; i + 1 < (int)m_path.size(); i++ ) {
+            for( int a = m_graph.begin( m_path[i] ); a < m_graph.end( m_path[i] ); a++ ) {
+                if( m_graph.target( a ) == m_path[i + 1] ) {
+                    double raised = (double)m_graph.weight( a ) * ( 1.0 + penalty );
+                    if( std::numeric_limits<ArcType>::is_integer ) {
+                        raised = std::ceil( raised );
+                    }
+                    m_graph.setWeight( a, raised < (double)CostTraits<ArcType>::infinity() ? ArcType( raised ) : m_graph.weight( a ) );
+                }
+            }
+        }
+    }
+    m_graph.restore();
+    for( int p = 0; p < (int)paths.size(); p++ ) {
+        for( int i = 0; i + 1 < (int)paths[p].size(); i++ ) {
+            m_used[arcBetween( paths[p][i], paths[p][i + 1] )] = 0;
+        }
+    }
+    return (int)paths.size();
+}
+
+#endif
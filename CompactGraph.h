@@ -0,0 +1,340 @@
+#ifndef COMPACTGRAPH_H
+#define COMPACTGRAPH_H
+
+#include <cstddef>
+#include <list>
+#include <vector>
+
+template <class NodeType, class ArcType> class Graph;
+template <class NodeType, class ArcType> class GraphNode;
+template <class NodeType, class ArcType> class GraphArc;
+
+// ----------------------------------------------------------------
+//  Name:           CompactGraph
+//  Description:    A read-only copy of a Graph's arcs stored as
+//                  flat arrays (compressed sparse rows). The arcs
+//                  leaving node n are m_targets[m_offsets[n]] up to
+//                  m_targets[m_offsets[n + 1] - 1]. The reverse
+//                  arcs (the arcs entering each node) are kept the
+//                  same way so searches can also run backwards.
+//                  Node ids are the indices used by the Graph.
+// ----------------------------------------------------------------
+template<class ArcType>
+class CompactGraph {
+private:
+
+// ----------------------------------------------------------------
+//  Description:    First arc of each node, plus one past the end.
+// ----------------------------------------------------------------
+    std::vector<int> m_offsets;
+
+// ----------------------------------------------------------------
+//  Description:    Node each arc points to, and its weight.
+// ----------------------------------------------------------------
+    std::vector<int> m_targets;
+    std::vector<ArcType> m_weights;
+
+// ----------------------------------------------------------------
+//  Description:    The same arrays for the reversed arcs.
+// ----------------------------------------------------------------
+    std::vector<int> m_rOffsets;
+    std::vector<int> m_rSources;
+    std::vector<ArcType> m_rWeights;
+
+// ----------------------------------------------------------------
+//  Description:    true for every index that holds a node.
+// ----------------------------------------------------------------
+    std::vector<bool> m_present;
+
+public:
+    CompactGraph() {}
+
+    template<class NodeType>
+    explicit CompactGraph( Graph<NodeType, ArcType> const & graph ) {
+        build( graph );
+    }
+
+    template<class NodeType>
+    void build( Graph<NodeType, ArcType> const & graph );
+    void build( CompactGraph const & source, std::vector<int> const & toInternal );
+    template<class ArcSource>
+    bool build( int size, ArcSource& source );
+    bool setWeight( int from, int to, ArcType weight );
+
+    // Accessors
+    int size() const {
+        return (int)m_present.size();
+    }
+
+    int arcCount() const {
+        return (int)m_targets.size();
+    }
+
+    bool present( int node ) const {
+        return m_present[node];
+    }
+
+    int begin( int node ) const {
+        return m_offsets[node];
+    }
+
+    int end( int node ) const {
+        return m_offsets[node + 1];
+    }
+
+    int target( int arc ) const {
+        return m_targets[arc];
+    }
+
+    ArcType weight( int arc ) const {
+        return m_weights[arc];
+    }
+
+    int rbegin( int node ) const {
+        return m_rOffsets[node];
+    }
+
+    int rend( int node ) const {
+        return m_rOffsets[node + 1];
+    }
+
+    int source( int arc ) const {
+        return m_rSources[arc];
+    }
+
+    ArcType rweight( int arc ) const {
+        return m_rWeights[arc];
+    }
+
+    int degree( int node ) const {
+        return m_offsets[node + 1] - m_offsets[node];
+    }
+
+    int inDegree( int node ) const {
+        return m_rOffsets[node + 1] - m_rOffsets[node];
+    }
+
+    // Bytes held by the arrays that grow with the nodes and the arcs,
+    // and how much of that is reserved but unused.
+    size_t nodeBytes() const {
+        return ( m_offsets.capacity() + m_rOffsets.capacity() ) * sizeof( int ) + m_present.capacity() / 8;
+    }
+
+    size_t arcBytes() const {
+        return ( m_targets.capacity() + m_rSources.capacity() ) * sizeof( int )
+             + ( m_weights.capacity() + m_rWeights.capacity() ) * sizeof( ArcType );
+    }
+
+    size_t slackBytes() const {
+        return ( m_offsets.capacity() - m_offsets.size() + m_rOffsets.capacity() - m_rOffsets.size() ) * sizeof( int )
+             + ( m_targets.capacity() - m_targets.size() + m_rSources.capacity() - m_rSources.size() ) * sizeof( int )
+             + ( m_weights.capacity() - m_weights.size() + m_rWeights.capacity() - m_rWeights.size() ) * sizeof( ArcType );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Copies the arcs out of the graph. Call this again
+//                  after the graph has been edited.
+//  Arguments:      The graph to copy.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+template<class NodeType>
+void CompactGraph<ArcType>::build( Graph<NodeType, ArcType> const & graph ) {
+    typedef GraphNode<NodeType, ArcType> Node;
+    typedef GraphArc<NodeType, ArcType> Arc;
+
+    int n = graph.maxNodes();
+    Node** pNodes = graph.nodeArray();
+
+    m_present.assign( n, false );
+    m_offsets.assign( n + 1, 0 );
+    m_rOffsets.assign( n + 1, 0 );
+    m_targets.clear();
+    m_weights.clear();
+
+    // size the arc arrays exactly rather than let them double.
+    size_t arcs = 0;
+    for( int i = 0; i < n; i++ ) {
+        if( pNodes[i] != 0 ) {
+            arcs += pNodes[i]->arcList().size();
+        }
+    }
+    m_targets.reserve( arcs );
+    m_weights.reserve( arcs );
+
+    // forward arcs are written out in node order.
+    for( int i = 0; i < n; i++ ) {
+        m_offsets[i] = (int)m_targets.size();
+        if( pNodes[i] != 0 ) {
+            m_present[i] = true;
+            typename std::list<Arc>::const_iterator iter = pNodes[i]->arcList().begin();
+            typename std::list<Arc>::const_iterator endIter = pNodes[i]->arcList().end();
+            for( ; iter != endIter; ++iter ) {
+                m_targets.push_back( (*iter).node()->index() );
+                m_weights.push_back( (*iter).weight() );
+                m_rOffsets[(*iter).node()->index() + 1]++;
+            }
+        }
+    }
+    m_offsets[n] = (int)m_targets.size();
+
+    // reverse arcs: count per target, prefix sum, then scatter.
+    for( int i = 0; i < n; i++ ) {
+        m_rOffsets[i + 1] += m_rOffsets[i];
+    }
+    m_rSources.resize( m_targets.size() );
+    m_rWeights.resize( m_targets.size() );
+    std::vector<int> fill( m_rOffsets.begin(), m_rOffsets.end() - 1 );
+    for( int i = 0; i < n; i++ ) {
+        for( int a = m_offsets[i]; a < m_offsets[i + 1]; a++ ) {
+            int slot = fill[m_targets[a]]++;
+            m_rSources[slot] = i;
+            m_rWeights[slot] = m_weights[a];
+        }
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           setWeight
+//  Description:    Changes the weight of an existing arc in both the
+//                  forward and reverse arrays, so a weight edit in
+//                  the Graph can be copied across without a rebuild.
+//                  Adding or removing arcs still needs build().
+//  Arguments:      The two ends of the arc and its new weight.
+//  Return Value:   false if there is no such arc.
+// ----------------------------------------------------------------
+template<class ArcType>
+bool CompactGraph<ArcType>::setWeight( int from, int to, ArcType weight ) {
+    int arc = begin( from );
+    while( arc < end( from ) && m_targets[arc] != to ) {
+        arc++;
+    }
+    int rarc = rbegin( to );
+    while( rarc < rend( to ) && m_rSources[rarc] != from ) {
+        rarc++;
+    }
+    if( arc == end( from ) || rarc == rend( to ) ) {
+        return false;
+    }
+    m_weights[arc] = weight;
+    m_rWeights[rarc] = weight;
+    return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Copies another CompactGraph with its nodes
+//                  renumbered, so that node n of the source becomes
+//                  node toInternal[n]. Arcs are remapped to match
+//                  and each node's arcs keep their order.
+//  Arguments:      The graph to copy and the new number of every
+//                  node (a permutation of 0 .. size - 1).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void CompactGraph<ArcType>::build( CompactGraph const & source, std::vector<int> const & toInternal ) {
+    int n = source.size();
+    std::vector<int> toExternal( n );
+    for( int i = 0; i < n; i++ ) {
+        toExternal[toInternal[i]] = i;
+    }
+
+    m_present.assign( n, false );
+    m_offsets.assign( n + 1, 0 );
+    m_rOffsets.assign( n + 1, 0 );
+    m_targets.clear();
+    m_weights.clear();
+    m_targets.reserve( source.arcCount() );
+    m_weights.reserve( source.arcCount() );
+
+    for( int i = 0; i < n; i++ ) {
+        int old = toExternal[i];
+        m_offsets[i] = (int)m_targets.size();
+        m_present[i] = source.present( old );
+        for( int a = source.begin( old ); a < source.end( old ); a++ ) {
+            int target = toInternal[source.target( a )];
+            m_targets.push_back( target );
+            m_weights.push_back( source.weight( a ) );
+            m_rOffsets[target + 1]++;
+        }
+    }
+    m_offsets[n] = (int)m_targets.size();
+
+    for( int i = 0; i < n; i++ ) {
+        m_rOffsets[i + 1] += m_rOffsets[i];
+    }
+    m_rSources.resize( m_targets.size() );
+    m_rWeights.resize( m_targets.size() );
+    std::vector<int> fill( m_rOffsets.begin(), m_rOffsets.end() - 1 );
+    for( int i = 0; i < n; i++ ) {
+        for( int a = m_offsets[i]; a < m_offsets[i + 1]; a++ ) {
+            int slot = fill[m_targets[a]]++;
+            m_rSources[slot] = i;
+            m_rWeights[slot] = m_weights[a];
+        }
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Builds the graph straight from a source of arcs
+//                  without holding the arc list in memory. The first
+//                  pass counts the arcs of each node and the second
+//                  writes every arc into its slot, so only the
+//                  finished arrays take space. Calling
+//                  source( visit ) must call visit( from, to, weight )
+//                  for every arc, in the same order each time, and
+//                  return false if the arcs could not be read.
+//  Arguments:      The number of nodes and the arc source.
+//  Return Value:   false if the source failed or gave different
+//                  arcs on the second pass.
+// ----------------------------------------------------------------
+template<class ArcType>
+template<class ArcSource>
+bool CompactGraph<ArcType>::build( int size, ArcSource& source ) {
+    m_present.assign( size, true );
+    m_offsets.assign( size + 1, 0 );
+    m_rOffsets.assign( size + 1, 0 );
+
+    // pass 1: out and in degree of every node.
+    std::vector<int>& offsets = m_offsets;
+    std::vector<int>& rOffsets = m_rOffsets;
+    bool read = source( [&]( int from, int to, ArcType ) {
+        offsets[from + 1]++;
+        rOffsets[to + 1]++;
+    } );
+    if( !read ) {
+        return false;
+    }
+    for( int i = 0; i < size; i++ ) {
+        m_offsets[i + 1] += m_offsets[i];
+        m_rOffsets[i + 1] += m_rOffsets[i];
+    }
+
+    // pass 2: scatter each arc into both directions.
+    m_targets.resize( m_offsets[size] );
+    m_weights.resize( m_offsets[size] );
+    m_rSources.resize( m_offsets[size] );
+    m_rWeights.resize( m_offsets[size] );
+    std::vector<int> fill( m_offsets.begin(), m_offsets.end() - 1 );
+    std::vector<int> rFill( m_rOffsets.begin(), m_rOffsets.end() - 1 );
+    bool same = true;
+    CompactGraph& self = *this;
+    read = source( [&]( int from, int to, ArcType weight ) {
+        if( fill[from] == self.m_offsets[from + 1] || rFill[to] == self.m_rOffsets[to + 1] ) {
+            same = false;
+            return;
+        }
+        int slot = fill[from]++;
+        self.m_targets[slot] = to;
+        self.m_weights[slot] = weight;
+        slot = rFill[to]++;
+        self.m_rSources[slot] = from;
+        self.m_rWeights[slot] = weight;
+    } );
+    return read && same && fill == std::vector<int>( m_offsets.begin() + 1, m_offsets.end() );
+}
+
+#endif
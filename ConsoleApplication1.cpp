@@ -30,21 +30,56 @@
 #include <string>
 #include <fstream>
 #include "Graph.h"
+#include "Reachability.h"
+#include "GraphView.h"
+#include "GraphLoader.h"
+#include "Footprint.h"
 
 using namespace std;
 
 typedef GraphArc<tuple<string, int, int>, int >ArcType;
 typedef GraphNode<tuple<string, int, int>, int >Node;
-std::vector<sf::Text> pathTaking;
-sf::Font font;
-void pProcess(Node * pNode) {
-	cout << "Visiting: " << std::get<0>(pNode->data()) << "Weight: " << std::get<1>(pNode->data()) << "Heuristic: " << std::get<2>(pNode->data()) << endl;
-	sf::Text temp;
-	temp.setCharacterSize(15);
-	temp.setFont(font);
-	temp.setStyle(sf::Text::Bold);
-	temp.setString("Name: " + std::get<0>(pNode->data()) + " Cost: " + std::to_string(std::get<1>(pNode->data())) + " Huer: " + std::to_string(std::get<2>(pNode->data())));
-	pathTaking.push_back(temp);
+
+// Shows the search on the nodes as it runs
+////////////////////////////
+struct SearchDisplay : NullVisitor {
+	Node * m_pStart;
+
+	SearchDisplay(Node * pStart) : m_pStart(pStart) {}
+
+	void ShowCost(Node * pNode) {
+		pNode->SetText("    " + (get<0>(pNode->data())) + "\n" + " C-" + std::to_string(get<1>(pNode->data())) + "\n" + " H-" + std::to_string(get<2>(pNode->data())));
+	}
+	void discover(Node * pNode) {
+		ShowCost(pNode);
+		// Change color of the node as to show it has been marked
+		if (pNode != m_pStart)
+			pNode->SetColor(sf::Color(0, 0, 255));
+	}
+	void relax(Node *, Node * pTo, int) {
+		ShowCost(pTo);
+	}
+};
+
+// Prints the path and adds a line for it to the path taking list
+////////////////////////////
+void ShowPath(std::vector<Node *> const & path, sf::Font const & font, std::vector<sf::Text> & pathTaking) {
+	for (int i = 0; i < path.size(); i++)
+	{
+		Node * pNode = path.at(i);
+		cout << "Visiting: " << std::get<0>(pNode->data()) << "Weight: " << std::get<1>(pNode->data()) << "Heuristic: " << std::get<2>(pNode->data()) << endl;
+		sf::Text temp;
+		temp.setCharacterSize(15);
+		temp.setFont(font);
+		temp.setStyle(sf::Text::Bold);
+		temp.setString("Name: " + std::get<0>(pNode->data()) + " Cost: " + std::to_string(std::get<1>(pNode->data())) + " Huer: " + std::to_string(std::get<2>(pNode->data())));
+		pathTaking.push_back(temp);
+
+		if (i == path.size() - 1)
+			pNode->SetColor(sf::Color(150, 0, 150));
+		else if (i != 0)
+			pNode->SetColor(sf::Color(255, 0, 0));
+	}
 }
 //////////////////////////////////////////////////////////// 
 /// Entry point of application 
@@ -53,69 +88,72 @@ int main(int argc, char *argv[])
 {
 	// Create the main window 
 	sf::RenderWindow App(sf::VideoMode(800, 700, 32), "SFML OpenGL");
+	sf::Font font;
 	font.loadFromFile("C:\\Windows\\Fonts\\GARA.TTF");
 
-	std::vector<sf::Text> display;
-	std::vector<sf::IntRect> nodeRect;
+	std::vector<sf::Text> pathTaking;
 	sf::Vector2i nodeStart, nodeEnd;
-	sf::Text text, startText, resetText, titleText;
+	sf::Text startText, resetText, titleText;
 	sf::RectangleShape startRectShape, resetRectShape;
 
-	text.setPosition(sf::Vector2f(600, 300));
-	text.setFont(font);
-	text.setStyle(sf::Text::Bold);
-	text.setColor(sf::Color(0, 255, 0));
-	text.setCharacterSize(15);
-
 	int startNodeNum = -1;
 	int endNodeNum = -1;
-	const int NUMOFNODES = 30;
 
 	bool startNode = false;
 	bool endNode = false;
 	bool aStar = false;
 
-	Graph<tuple<string, int, int>, int > myGraph(NUMOFNODES);
+	// Search mode, picked with the 1/2/3 keys
+	SearchMode searchMode = SEARCH_ASTAR;
+	const float SEARCHWEIGHT = 1.5f;
 
-	string c;
-	int i = 0;
-	int x = 0;
-	int y = 0;
+	// How far from a node's centre a click still picks it, the drawn node radius
+	const float PICKRADIUS = 30.0f;
 
-	// Create a Node and read in Node Position and Name from file
+	// Read Node Names and Positions from file, the graph is sized to fit
 	///////////////////////////
-	ifstream myfile;
-	myfile.open("nodes.txt");
+	vector<NodeRecord> nodeRecords;
+	LoadErrors loadErrors;
+	if (!loadNodes("nodes.txt", nodeRecords, loadErrors)) {
+		if (loadErrors.count() == 0)
+			cout << "Could not open nodes.txt" << endl;
+		loadErrors.print(cout);
+		return EXIT_FAILURE;
+	}
+	const int NUMOFNODES = (int)nodeRecords.size();
 
-	while (myfile >> c >> x >> y)
-		myGraph.addNode(make_tuple(c, std::numeric_limits<int>::max() * 0.00001, std::numeric_limits<int>::max() * 0.00001), i++, sf::Vector2f(x + 50, y + 100), font);
-	myfile.close();
+	Graph<tuple<string, int, int>, int > myGraph(NUMOFNODES);
 
+	// Create a Node for each one read in
+	///////////////////////////
+	for (int i = 0; i < NUMOFNODES; i++)
+		myGraph.addNode(make_tuple(nodeRecords[i].name, CostTraits<int>::infinity(), CostTraits<int>::infinity()), i, sf::Vector2f(nodeRecords[i].x + 50, nodeRecords[i].y + 100), font);
 
-	// Add Arcs from file and Draw weight values between Arcs
+	// Add Arcs from file
 	///////////////////////////
-	myfile.open("arcs.txt");
-	int from, to, weight;
-	while (myfile >> from >> to >> weight) 
-	{
-		myGraph.addArc(from, to, weight);
-		sf::Vector2f pos = ((myGraph.nodeArray()[from]->getPosition() - myGraph.nodeArray()[to]->getPosition()) / 2.0f) + myGraph.nodeArray()[to]->getPosition();
-		text.setPosition(pos.x - 10, pos.y - 10);
-		text.setString(std::to_string(weight));
-		display.push_back(text);
+	if (!loadArcs("arcs.txt", NUMOFNODES, [&](int from, int to, int weight) { myGraph.addArc(from, to, weight); }, loadErrors))
+		cout << "Could not open arcs.txt" << endl;
 
-	}
-	myfile.close();
+	// Report any lines that could not be read
+	loadErrors.print(cout);
 
-	// Set Up Collision for Nodes with Mouse Click
+	// Batched drawing of the nodes, arcs and weight values
+	// Mouse wheel zooms, arrow keys pan
 	///////////////////////////
-	for (int i = 0; i < NUMOFNODES; i++)
-	{
-		sf::Vector2f nodePos = myGraph.nodeArray()[i]->getPosition();
-		sf::IntRect r(nodePos.x - 25, nodePos.y - 25, myGraph.nodeArray()[i]->GetSize() * 2, myGraph.nodeArray()[i]->GetSize() * 2);
-		nodeRect.push_back(r);
-	}
+	GraphView<tuple<string, int, int>, int > graphView(myGraph, sf::FloatRect(0, 0, 800, 700), font);
+	const float PANSTEP = 40.0f;
 
+	// Label connected components so impossible requests are rejected up front
+	///////////////////////////
+	CompactGraph<int> compactGraph(myGraph);
+	ReachabilityIndex<int> reachability(compactGraph);
+
+	// Memory used by each layout of the graph
+	///////////////////////////
+	printFootprintHeader(cout);
+	printFootprint(cout, footprint(myGraph));
+	printFootprint(cout, footprint(compactGraph));
+	printFootprint(cout, footprint(PackedGraph<int>(compactGraph)));
 
 	// Extra stuff - Buttons etc
 	///////////////////////////
@@ -159,9 +197,43 @@ int main(int argc, char *argv[])
 				// Escape key : exit 
 				if (Event.key.code == sf::Keyboard::Escape)
 					App.close();
+
+				if (Event.key.code == sf::Keyboard::Left)
+					graphView.pan(sf::Vector2f(-PANSTEP, 0));
+				if (Event.key.code == sf::Keyboard::Right)
+					graphView.pan(sf::Vector2f(PANSTEP, 0));
+				if (Event.key.code == sf::Keyboard::Up)
+					graphView.pan(sf::Vector2f(0, -PANSTEP));
+				if (Event.key.code == sf::Keyboard::Down)
+					graphView.pan(sf::Vector2f(0, PANSTEP));
+
+				// 1 : A*, 2 : weighted A*, 3 : focal search
+				if (Event.key.code == sf::Keyboard::Num1)
+				{
+					searchMode = SEARCH_ASTAR;
+					titleText.setString("Path Taking");
+				}
+				if (Event.key.code == sf::Keyboard::Num2)
+				{
+					searchMode = SEARCH_WEIGHTED;
+					titleText.setString("Path Taking (wA*)");
+				}
+				if (Event.key.code == sf::Keyboard::Num3)
+				{
+					searchMode = SEARCH_FOCAL;
+					titleText.setString("Path Taking (A*e)");
+				}
+			}
+			if (Event.type == sf::Event::MouseWheelMoved)
+			{
+				sf::Vector2f around = App.mapPixelToCoords(sf::Vector2i(Event.mouseWheel.x, Event.mouseWheel.y), graphView.view());
+				graphView.zoom(Event.mouseWheel.delta > 0 ? 0.8f : 1.25f, around);
 			}
 			if (sf::Mouse::isButtonPressed(sf::Mouse::Left)|| sf::Mouse::isButtonPressed(sf::Mouse::Right))
 			{
+				// node colours may change below
+				graphView.markColorsDirty();
+
 				sf::IntRect mouseRect(sf::Mouse::getPosition(App).x, sf::Mouse::getPosition(App).y, 1, 1);
 
 				// Reset Function
@@ -179,7 +251,7 @@ int main(int argc, char *argv[])
 						for (int i = 0; i < NUMOFNODES; i++)
 						{
 							myGraph.nodeArray()[i]->Reset();
-							myGraph.nodeArray()[i]->setData(make_tuple(get<0>(myGraph.nodeArray()[i]->data()), std::numeric_limits<int>::max() * 0.00001, std::numeric_limits<int>::max() * 0.00001));
+							myGraph.nodeArray()[i]->setData(make_tuple(get<0>(myGraph.nodeArray()[i]->data()), CostTraits<int>::infinity(), CostTraits<int>::infinity()));
 						}
 					}
 				}
@@ -193,7 +265,13 @@ int main(int argc, char *argv[])
 					if (mouseRect.intersects(startRect))
 					{
 						std::vector<Node *> thePath;
-						myGraph.aStar(myGraph.nodeArray()[startNodeNum], myGraph.nodeArray()[endNodeNum], pProcess, thePath);
+						if (reachability.mayReach(startNodeNum, endNodeNum))
+						{
+							myGraph.aStar(myGraph.nodeArray()[startNodeNum], myGraph.nodeArray()[endNodeNum], thePath, searchMode, SEARCHWEIGHT, SearchDisplay(myGraph.nodeArray()[startNodeNum]));
+							ShowPath(thePath, font, pathTaking);
+						}
+						else
+							cout << "No path: the end node cannot be reached from the start node" << endl;
 						aStar = true;
 					}
 				}
@@ -203,40 +281,38 @@ int main(int argc, char *argv[])
 			////////////////////////////
 			if (sf::Mouse::isButtonPressed(sf::Mouse::Left) && !startNode)
 			{
-				sf::IntRect mouseRect(sf::Mouse::getPosition(App).x, sf::Mouse::getPosition(App).y, 1, 1);
-				for (int i = 0; i < NUMOFNODES; i++)
+				// Pick the node under the mouse through the spatial index
+				sf::Vector2f mouseWorld = App.mapPixelToCoords(sf::Mouse::getPosition(App), graphView.view());
+				Node * pPicked = myGraph.nearestNode(mouseWorld, PICKRADIUS);
+				if (pPicked != 0)
 				{
-					if (mouseRect.intersects((nodeRect.at(i))))
-					{
-						myGraph.nodeArray()[i]->SetColor(sf::Color(255, 255, 0));
-						startNodeNum = i;
-						startNode = true;
-					}
+					pPicked->SetColor(sf::Color(255, 255, 0));
+					startNodeNum = pPicked->index();
+					startNode = true;
 				}
 			}
 			// Select Start Node
 			////////////////////////////
 			if (sf::Mouse::isButtonPressed(sf::Mouse::Right) && !endNode)
 			{
-				sf::IntRect mouseRect(sf::Mouse::getPosition(App).x, sf::Mouse::getPosition(App).y, 1, 1);
-				for (int i = 0; i < NUMOFNODES; i++)
+				sf::Vector2f mouseWorld = App.mapPixelToCoords(sf::Mouse::getPosition(App), graphView.view());
+				Node * pPicked = myGraph.nearestNode(mouseWorld, PICKRADIUS);
+				if (pPicked != 0)
 				{
-					if (mouseRect.intersects((nodeRect.at(i))))
-					{
-						myGraph.nodeArray()[i]->SetColor(sf::Color(150, 0, 150));
-						endNodeNum = i;
-						endNode = true;
+					pPicked->SetColor(sf::Color(150, 0, 150));
+					endNodeNum = pPicked->index();
+					endNode = true;
 
-						sf::Vector2f endPos = myGraph.nodeArray()[endNodeNum]->getPosition();
-						for (int i = 0; i < NUMOFNODES; i++)
-						{
-							sf::Vector2f startPos = myGraph.nodeArray()[i]->getPosition();
-							float distance = sqrt(((endPos.x - startPos.x)*(endPos.x - startPos.x) + (endPos.y - startPos.y)*(endPos.y - startPos.y)));
+					sf::Vector2f endPos = myGraph.nodeArray()[endNodeNum]->getPosition();
+					for (int i = 0; i < NUMOFNODES; i++)
+					{
+						sf::Vector2f startPos = myGraph.nodeArray()[i]->getPosition();
+						float distance = sqrt(((endPos.x - startPos.x)*(endPos.x - startPos.x) + (endPos.y - startPos.y)*(endPos.y - startPos.y)));
 
-							std::string temp = ("    " + (get<0>(myGraph.nodeArray()[i]->data())) + "\n" + " C-??? " + "\n" + " H-" + std::to_string((int)distance));
-							myGraph.nodeArray()[i]->SetText(temp);
-							myGraph.nodeArray()[i]->setData(make_tuple(get<0>(myGraph.nodeArray()[i]->data()), get<1>(myGraph.nodeArray()[i]->data()), distance));
-						}
+						std::string temp = ("    " + (get<0>(myGraph.nodeArray()[i]->data())) + "\n" + " C-??? " + "\n" + " H-" + std::to_string((int)distance));
+						myGraph.nodeArray()[i]->SetText(temp);
+						// Round the distance down so it never overestimates the cost
+						myGraph.nodeArray()[i]->setData(make_tuple(get<0>(myGraph.nodeArray()[i]->data()), get<1>(myGraph.nodeArray()[i]->data()), CostTraits<int>::fromHeuristic(distance)));
 					}
 				}
 			}
@@ -257,13 +333,7 @@ int main(int argc, char *argv[])
 			App.draw(pathTaking.at(i));
 		}
 
-		for (int i = 0; i < NUMOFNODES; i++)
-			myGraph.nodeArray()[i]->DrawArcs(App);
-		for (int i = 0; i < NUMOFNODES; i++)
-			myGraph.nodeArray()[i]->Draw(App);
-
-		for (int i = 0; i < display.size(); i++)
-			App.draw(display.at(i));
+		graphView.draw(App);
 
 		// Finally, display rendered frame on screen 
 		App.display();
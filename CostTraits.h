@@ -0,0 +1,124 @@
+#ifndef COSTTRAITS_H
+#define COSTTRAITS_H
+
+#include <limits>
+#include <cmath>
+#include <cstdint>
+
+// ----------------------------------------------------------------
+//  Name:           IntegerCostTraits
+//  Description:    Cost arithmetic for integer costs. The largest
+//                  value stands for "unreached" and addition
+//                  saturates there instead of wrapping, so
+//                  infinity + weight is still infinity. Weights are
+//                  rounded up and heuristics down when converted,
+//                  which keeps an admissible heuristic admissible
+//                  (see AStarSearch).
+// ----------------------------------------------------------------
+template<class Cost>
+struct IntegerCostTraits {
+    static_assert( std::numeric_limits<Cost>::is_integer, "IntegerCostTraits needs an integer type" );
+
+    typedef Cost Type;
+
+    static Cost zero() {
+        return 0;
+    }
+
+    static Cost infinity() {
+        return std::numeric_limits<Cost>::max();
+    }
+
+    static bool isInfinite( Cost cost ) {
+        return cost == infinity();
+    }
+
+    // a + b for b >= 0, clamped to infinity.
+    static Cost add( Cost a, Cost b ) {
+        return a >= infinity() - b ? infinity() : Cost( a + b );
+    }
+
+    // A weight or cost in scaled units, rounded up; never infinity.
+    static Cost fromWeight( double value ) {
+        double rounded = ceil( value );
+        if( rounded <= 0.0 ) {
+            return 0;
+        }
+        if( rounded >= (double)infinity() ) {
+            return Cost( infinity() - 1 );
+        }
+        return Cost( rounded );
+    }
+
+    // A heuristic estimate in scaled units, rounded down.
+    static Cost fromHeuristic( double value ) {
+        if( value <= 0.0 ) {
+            return 0;
+        }
+        if( value >= (double)infinity() ) {
+            return Cost( infinity() - 1 );
+        }
+        return Cost( floor( value ) );
+    }
+
+    static double toDouble( Cost cost ) {
+        return (double)cost;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           FloatCostTraits
+//  Description:    Cost arithmetic for floating point costs, which
+//                  already have an infinity that absorbs additions.
+// ----------------------------------------------------------------
+template<class Cost>
+struct FloatCostTraits {
+    static_assert( std::numeric_limits<Cost>::has_infinity, "FloatCostTraits needs a type with an infinity" );
+
+    typedef Cost Type;
+
+    static Cost zero() {
+        return 0;
+    }
+
+    static Cost infinity() {
+        return std::numeric_limits<Cost>::infinity();
+    }
+
+    static bool isInfinite( Cost cost ) {
+        return cost == infinity();
+    }
+
+    static Cost add( Cost a, Cost b ) {
+        return a + b;
+    }
+
+    static Cost fromWeight( double value ) {
+        return Cost( value );
+    }
+
+    static Cost fromHeuristic( double value ) {
+        return value > 0.0 ? Cost( value ) : Cost( 0 );
+    }
+
+    static double toDouble( Cost cost ) {
+        return (double)cost;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           CostTraits
+//  Description:    The cost types a search can use. Any other type
+//                  fails to compile. uint16_t halves the cost array
+//                  of uint32_t and suits graphs whose longest path,
+//                  in fixed-point units, stays below 65535.
+// ----------------------------------------------------------------
+template<class Cost> struct CostTraits;
+
+template<> struct CostTraits<uint16_t> : IntegerCostTraits<uint16_t> {};
+template<> struct CostTraits<uint32_t> : IntegerCostTraits<uint32_t> {};
+template<> struct CostTraits<int> : IntegerCostTraits<int> {};
+template<> struct CostTraits<float> : FloatCostTraits<float> {};
+template<> struct CostTraits<double> : FloatCostTraits<double> {};
+
+#endif
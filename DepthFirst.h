@@ -0,0 +1,367 @@
+#ifndef DEPTHFIRST_H
+#define DEPTHFIRST_H
+
+#include <vector>
+#include "CompactGraph.h"
+
+// ----------------------------------------------------------------
+//  Description:    What a visitor tells the search to do after a
+//                  node has been discovered, or an arc to an already
+//                  discovered node has been seen.
+//                  VISIT_CONTINUE - go on into the node's children.
+//                  VISIT_PRUNE    - skip the node's children (the
+//                                   same as VISIT_CONTINUE for an
+//                                   arc).
+//                  VISIT_STOP     - end the whole search now.
+// ----------------------------------------------------------------
+enum VisitResult { VISIT_CONTINUE, VISIT_PRUNE, VISIT_STOP };
+
+// ----------------------------------------------------------------
+//  Name:           DepthFirstSearch
+//  Description:    Iterative depth-first search over a CompactGraph.
+//                  The path being walked is kept on an explicit
+//                  stack instead of the call stack, so depth is only
+//                  limited by memory. The stack and the visited
+//                  array are kept between runs; a new run bumps a
+//                  generation number instead of clearing them.
+//
+//                  A visitor receives:
+//                  VisitResult discover( int node, int parent )
+//                  VisitResult nonTreeArc( int from, int to )
+//                  void finish( int node, int parent )
+//                  parent is -1 for the node a run started from.
+// ----------------------------------------------------------------
+template<class ArcType>
+class DepthFirstSearch {
+private:
+
+// ----------------------------------------------------------------
+//  Description:    One entry per node on the current path: the
+//                  node, the next arc to look at and its parent.
+// ----------------------------------------------------------------
+    struct Frame {
+        int node;
+        int arc;
+        int parent;
+    };
+
+    std::vector<Frame> m_stack;
+
+// ----------------------------------------------------------------
+//  Description:    Generation in which each node was discovered.
+// ----------------------------------------------------------------
+    std::vector<unsigned> m_seen;
+    unsigned m_generation;
+
+    CompactGraph<ArcType> const * m_pGraph;
+
+public:
+    explicit DepthFirstSearch( CompactGraph<ArcType> const & graph ) : m_generation( 0 ), m_pGraph( &graph ) {}
+
+    // Forgets every node discovered so far.
+    void clear() {
+        if( (int)m_seen.size() != m_pGraph->size() ) {
+            m_seen.assign( m_pGraph->size(), 0 );
+            m_generation = 0;
+        }
+        if( ++m_generation == 0 ) {
+            // the counter wrapped, so old stamps could look current.
+            m_seen.assign( m_pGraph->size(), 0 );
+            m_generation = 1;
+        }
+    }
+
+    bool discovered( int node ) const {
+        return m_seen[node] == m_generation;
+    }
+
+    template<class Visitor>
+    bool run( int start, Visitor& visitor );
+
+    template<class Visitor>
+    bool runAll( Visitor& visitor );
+};
+
+// ----------------------------------------------------------------
+//  Name:           run
+//  Description:    Searches from the start node. Nodes discovered by
+//                  earlier runs since the last clear() are skipped,
+//                  which is how runAll covers the whole graph.
+//  Arguments:      The starting node and the visitor.
+//  Return Value:   false if the visitor stopped the search.
+// ----------------------------------------------------------------
+template<class ArcType>
+template<class Visitor>
+bool DepthFirstSearch<ArcType>::run( int start, Visitor& visitor ) {
+    CompactGraph<ArcType> const & graph = *m_pGraph;
+    if( (int)m_seen.size() != graph.size() ) {
+        clear();
+    }
+    if( discovered( start ) || !graph.present( start ) ) {
+        return true;
+    }
+
+    m_seen[start] = m_generation;
+    VisitResult result = visitor.discover( start, -1 );
+    if( result == VISIT_STOP ) {
+        return false;
+    }
+    Frame first = { start, result == VISIT_PRUNE ? graph.end( start ) : graph.begin( start ), -1 };
+    m_stack.push_back( first );
+
+    while( m_stack.size() != 0 ) {
+        Frame& top = m_stack.back();
+
+        if( top.arc == graph.end( top.node ) ) {
+            // every child is done, so the node is finished.
+            int node = top.node;
+            int parent = top.parent;
+            m_stack.pop_back();
+            visitor.finish( node, parent );
+            continue;
+        }
+
+        int from = top.node;
+        int child = graph.target( top.arc++ );
+        if( discovered( child ) ) {
+            if( visitor.nonTreeArc( from, child ) == VISIT_STOP ) {
+                m_stack.clear();
+                return false;
+            }
+            continue;
+        }
+
+        m_seen[child] = m_generation;
+        result = visitor.discover( child, from );
+        if( result == VISIT_STOP ) {
+            m_stack.clear();
+            return false;
+        }
+        // top may have moved if the stack grew, so push a fresh frame.
+        Frame frame = { child, result == VISIT_PRUNE ? graph.end( child ) : graph.begin( child ), from };
+        m_stack.push_back( frame );
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           runAll
+//  Description:    Clears the search and runs it from every node in
+//                  index order that is still undiscovered.
+//  Arguments:      The visitor.
+//  Return Value:   false if the visitor stopped the search.
+// ----------------------------------------------------------------
+template<class ArcType>
+template<class Visitor>
+bool DepthFirstSearch<ArcType>::runAll( Visitor& visitor ) {
+    clear();
+    for( int node = 0; node < m_pGraph->size(); node++ ) {
+        if( run( node, visitor ) == false ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           TopologicalVisitor
+//  Description:    Records nodes as they finish. The reverse of the
+//                  finishing order is a topological order. An arc
+//                  back to a node still on the path is a cycle; the
+//                  visitor notes it and returns VISIT_STOP, which
+//                  ends the search there.
+// ----------------------------------------------------------------
+struct TopologicalVisitor {
+    std::vector<int>& order;
+    std::vector<char> onPath;
+    bool cycle;
+
+    TopologicalVisitor( std::vector<int>& o, int size ) : order( o ), onPath( size, 0 ), cycle( false ) {}
+
+    VisitResult discover( int node, int ) {
+        onPath[node] = 1;
+        return VISIT_CONTINUE;
+    }
+    VisitResult nonTreeArc( int, int to ) {
+        if( onPath[to] ) {
+            cycle = true;
+            return VISIT_STOP;
+        }
+        return VISIT_CONTINUE;
+    }
+    void finish( int node, int ) {
+        onPath[node] = 0;
+        order.push_back( node );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           topologicalOrder
+//  Description:    Orders the nodes so every arc goes from an
+//                  earlier node to a later one.
+//  Arguments:      The graph and the order to fill in.
+//  Return Value:   false if the graph has a cycle (order is then
+//                  incomplete).
+// ----------------------------------------------------------------
+template<class ArcType>
+bool topologicalOrder( CompactGraph<ArcType> const & graph, std::vector<int>& order ) {
+    order.clear();
+    DepthFirstSearch<ArcType> dfs( graph );
+    TopologicalVisitor visitor( order, graph.size() );
+    dfs.clear();
+    for( int node = 0; node < graph.size() && !visitor.cycle; node++ ) {
+        dfs.run( node, visitor );
+    }
+    if( visitor.cycle ) {
+        return false;
+    }
+    // reverse the finishing order.
+    for( int i = 0, j = (int)order.size() - 1; i < j; i++, j-- ) {
+        int swap = order[i];
+        order[i] = order[j];
+        order[j] = swap;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           TarjanVisitor
+//  Description:    Tarjan's strongly connected components. Each
+//                  node gets a discovery number and a low link (the
+//                  lowest discovery number it can reach back to).
+//                  A node whose low link is its own number is the
+//                  root of a component, which is everything above
+//                  it on the component stack.
+// ----------------------------------------------------------------
+struct TarjanVisitor {
+    std::vector<int>& component;
+    std::vector<int> number;
+    std::vector<int> low;
+    std::vector<int> stack;
+    std::vector<char> onStack;
+    int counter;
+    int components;
+
+    TarjanVisitor( std::vector<int>& c, int size )
+        : component( c ), number( size, -1 ), low( size, -1 ), onStack( size, 0 ), counter( 0 ), components( 0 ) {
+        component.assign( size, -1 );
+    }
+
+    VisitResult discover( int node, int ) {
+        number[node] = low[node] = counter++;
+        stack.push_back( node );
+        onStack[node] = 1;
+        return VISIT_CONTINUE;
+    }
+    VisitResult nonTreeArc( int from, int to ) {
+        if( onStack[to] && number[to] < low[from] ) {
+            low[from] = number[to];
+        }
+        return VISIT_CONTINUE;
+    }
+    void finish( int node, int parent ) {
+        if( low[node] == number[node] ) {
+            int member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                onStack[member] = 0;
+                component[member] = components;
+            } while( member != node );
+            components++;
+        }
+        if( parent != -1 && low[node] < low[parent] ) {
+            low[parent] = low[node];
+        }
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           strongComponents
+//  Description:    Labels every node with its strongly connected
+//                  component. Two nodes with the same label can
+//                  reach each other. Labels come out in reverse
+//                  topological order of the components.
+//  Arguments:      The graph and the labels to fill in (-1 for
+//                  indices without a node).
+//  Return Value:   The number of components.
+// ----------------------------------------------------------------
+template<class ArcType>
+int strongComponents( CompactGraph<ArcType> const & graph, std::vector<int>& component ) {
+    DepthFirstSearch<ArcType> dfs( graph );
+    TarjanVisitor visitor( component, graph.size() );
+    dfs.runAll( visitor );
+    return visitor.components;
+}
+
+// ----------------------------------------------------------------
+//  Name:           ArticulationVisitor
+//  Description:    Finds the nodes whose removal splits the graph,
+//                  treating every arc as two-way. A non-root node is
+//                  a cut node if some child cannot reach above it
+//                  without passing through it; the root is one if
+//                  it has more than one child.
+// ----------------------------------------------------------------
+struct ArticulationVisitor {
+    std::vector<char>& cut;
+    std::vector<int> number;
+    std::vector<int> low;
+    std::vector<int> parentOf;
+    std::vector<int> children;
+    int counter;
+
+    ArticulationVisitor( std::vector<char>& c, int size )
+        : cut( c ), number( size, -1 ), low( size, -1 ), parentOf( size, -1 ), children( size, 0 ), counter( 0 ) {
+        cut.assign( size, 0 );
+    }
+
+    VisitResult discover( int node, int parent ) {
+        number[node] = low[node] = counter++;
+        parentOf[node] = parent;
+        return VISIT_CONTINUE;
+    }
+    VisitResult nonTreeArc( int from, int to ) {
+        if( to != parentOf[from] && number[to] < low[from] ) {
+            low[from] = number[to];
+        }
+        return VISIT_CONTINUE;
+    }
+    void finish( int node, int parent ) {
+        if( parent == -1 ) {
+            if( children[node] > 1 ) {
+                cut[node] = 1;
+            }
+            return;
+        }
+        children[parent]++;
+        if( low[node] < low[parent] ) {
+            low[parent] = low[node];
+        }
+        if( parentOf[parent] != -1 && low[node] >= number[parent] ) {
+            cut[parent] = 1;
+        }
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           articulationPoints
+//  Description:    Flags the cut nodes of the graph. Every arc must
+//                  have a matching reverse arc (see
+//                  ReachabilityIndex::exact), otherwise the result
+//                  is for the arcs as given.
+//  Arguments:      The graph and the flags to fill in.
+//  Return Value:   The number of cut nodes.
+// ----------------------------------------------------------------
+template<class ArcType>
+int articulationPoints( CompactGraph<ArcType> const & graph, std::vector<char>& cut ) {
+    DepthFirstSearch<ArcType> dfs( graph );
+    ArticulationVisitor visitor( cut, graph.size() );
+    dfs.runAll( visitor );
+    int count = 0;
+    for( int i = 0; i < (int)cut.size(); i++ ) {
+        count += cut[i];
+    }
+    return count;
+}
+
+#endif
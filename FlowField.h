@@ -0,0 +1,308 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include <vector>
+#include "CompactGraph.h"
+#include "CostTraits.h"
+#include "PriorityQueues.h"
+#include "Parallel.h"
+
+// ----------------------------------------------------------------
+//  Name:           FlowField
+//  Description:    The cheapest way to a goal from every node at
+//                  once, for crowds of agents that share a
+//                  destination. One Dijkstra search runs backwards
+//                  from the goal over the reverse arcs and leaves
+//                  each node's cost to the goal and its next hop,
+//                  so an agent reads its path off in time
+//                  proportional to the path length with no search
+//                  of its own.
+//
+//                  Given several goals, every node heads for its
+//                  nearest one.
+//
+//                  When an arc's weight changes (copy it across
+//                  with CompactGraph::setWeight), arcChanged
+//                  repairs only the part of the field the change
+//                  affects.
+//
+//                  There is no heuristic, so keys never go down and
+//                  the radix heap is safe; it is the default for
+//                  integer costs.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost = ArcType, class Queue = typename MonotoneQueue<Cost>::Type>
+class FlowField {
+private:
+    typedef CostTraits<Cost> Traits;
+
+    CompactGraph<ArcType> const * m_pGraph;
+    std::vector<int> m_goals;
+
+// ----------------------------------------------------------------
+//  Description:    Cost from each node to its goal, and the next
+//                  node on the way there (-1 at a goal and at nodes
+//                  that cannot reach one).
+// ----------------------------------------------------------------
+    std::vector<Cost> m_cost;
+    std::vector<int> m_next;
+
+// ----------------------------------------------------------------
+//  Description:    Scratch space for repairs after a weight rise.
+// ----------------------------------------------------------------
+    std::vector<bool> m_affected;
+    std::vector<int> m_subtree;
+
+    Queue m_queue;
+
+    Cost arcCost( ArcType weight ) const {
+        return Traits::fromWeight( weight );
+    }
+
+    void propagate();
+    void raise( int from );
+
+public:
+    FlowField() : m_pGraph( 0 ) {}
+
+    explicit FlowField( CompactGraph<ArcType> const & graph ) : m_pGraph( &graph ) {}
+
+    void setGraph( CompactGraph<ArcType> const & graph ) {
+        m_pGraph = &graph;
+    }
+
+    void build( int goal ) {
+        build( std::vector<int>( 1, goal ) );
+    }
+
+    void build( std::vector<int> const & goals );
+    void arcChanged( int from, int to );
+    bool path( int from, std::vector<int>& path ) const;
+
+    // Accessors
+    Cost cost( int node ) const {
+        return m_cost[node];
+    }
+
+    int nextHop( int node ) const {
+        return m_next[node];
+    }
+
+    bool reachable( int node ) const {
+        return !Traits::isInfinite( m_cost[node] );
+    }
+
+    std::vector<int> const & goals() const {
+        return m_goals;
+    }
+
+    // Bytes held by the field.
+    size_t bytes() const {
+        return m_cost.capacity() * sizeof( Cost ) + m_next.capacity() * sizeof( int )
+             + m_affected.capacity() / 8 + m_subtree.capacity() * sizeof( int ) + m_queue.bytes();
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           propagate
+//  Description:    Dijkstra over the reverse arcs from whatever is
+//                  in the queue. A node is only queued when its cost
+//                  drops, so an entry whose key no longer matches
+//                  the node's cost is stale and skipped.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+void FlowField<ArcType, Cost, Queue>::propagate() {
+    CompactGraph<ArcType> const & graph = *m_pGraph;
+    while( !m_queue.empty() ) {
+        Cost key;
+        int node = m_queue.pop( key );
+        if( m_cost[node] < key ) {
+            continue;
+        }
+        for( int a = graph.rbegin( node ); a < graph.rend( node ); a++ ) {
+            int source = graph.source( a );
+            Cost c = Traits::add( m_cost[node], arcCost( graph.rweight( a ) ) );
+            if( c < m_cost[source] ) {
+                m_cost[source] = c;
+                m_next[source] = node;
+                m_queue.push( c, source );
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Computes the field from scratch.
+//  Arguments:      The goals.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+void FlowField<ArcType, Cost, Queue>::build( std::vector<int> const & goals ) {
+    int n = m_pGraph->size();
+    m_goals = goals;
+    m_cost.assign( n, Traits::infinity() );
+    m_next.assign( n, -1 );
+    m_affected.assign( n, false );
+    m_queue.clear();
+
+    for( int i = 0; i < (int)goals.size(); i++ ) {
+        if( m_pGraph->present( goals[i] ) && m_cost[goals[i]] != Traits::zero() ) {
+            m_cost[goals[i]] = Traits::zero();
+            m_queue.push( Traits::zero(), goals[i] );
+        }
+    }
+    propagate();
+}
+
+// ----------------------------------------------------------------
+//  Name:           raise
+//  Description:    Repairs the field after the arc from a node to
+//                  its next hop got dearer. Every node whose route
+//                  runs through that node (its subtree in the
+//                  next-hop tree) loses its cost; each then takes
+//                  the best offer from neighbours outside the
+//                  subtree and the search carries on from there.
+//                  Nodes outside the subtree are untouched.
+//  Arguments:      The node whose arc changed.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+void FlowField<ArcType, Cost, Queue>::raise( int from ) {
+    CompactGraph<ArcType> const & graph = *m_pGraph;
+
+    // gather the subtree through the reverse arcs.
+    m_subtree.clear();
+    m_subtree.push_back( from );
+    m_affected[from] = true;
+    for( int i = 0; i < (int)m_subtree.size(); i++ ) {
+        int node = m_subtree[i];
+        for( int a = graph.rbegin( node ); a < graph.rend( node ); a++ ) {
+            int source = graph.source( a );
+            if( m_next[source] == node && !m_affected[source] ) {
+                m_affected[source] = true;
+                m_subtree.push_back( source );
+            }
+        }
+    }
+    for( int i = 0; i < (int)m_subtree.size(); i++ ) {
+        m_cost[m_subtree[i]] = Traits::infinity();
+        m_next[m_subtree[i]] = -1;
+    }
+
+    // best route out of the subtree for each of its nodes.
+    m_queue.clear();
+    for( int i = 0; i < (int)m_subtree.size(); i++ ) {
+        int node = m_subtree[i];
+        for( int a = graph.begin( node ); a < graph.end( node ); a++ ) {
+            int target = graph.target( a );
+            if( m_affected[target] ) {
+                continue;
+            }
+            Cost c = Traits::add( m_cost[target], arcCost( graph.weight( a ) ) );
+            if( c < m_cost[node] ) {
+                m_cost[node] = c;
+                m_next[node] = target;
+            }
+        }
+        if( !Traits::isInfinite( m_cost[node] ) ) {
+            m_queue.push( m_cost[node], node );
+        }
+    }
+    for( int i = 0; i < (int)m_subtree.size(); i++ ) {
+        m_affected[m_subtree[i]] = false;
+    }
+    propagate();
+}
+
+// ----------------------------------------------------------------
+//  Name:           arcChanged
+//  Description:    Brings the field up to date after the weight of
+//                  the arc from -> to changed in the graph. A
+//                  cheaper arc spreads lower costs outwards from
+//                  from; a dearer arc only matters if it was from's
+//                  next hop, and then only from's subtree is redone.
+//  Arguments:      The two ends of the arc.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+void FlowField<ArcType, Cost, Queue>::arcChanged( int from, int to ) {
+    CompactGraph<ArcType> const & graph = *m_pGraph;
+    int arc = graph.begin( from );
+    while( arc < graph.end( from ) && graph.target( arc ) != to ) {
+        arc++;
+    }
+    if( arc == graph.end( from ) ) {
+        return;
+    }
+
+    Cost offer = Traits::add( m_cost[to], arcCost( graph.weight( arc ) ) );
+    if( m_next[from] == to && m_cost[from] < offer ) {
+        raise( from );
+    }
+    else if( offer < m_cost[from] ) {
+        m_cost[from] = offer;
+        m_next[from] = to;
+        m_queue.clear();
+        m_queue.push( offer, from );
+        propagate();
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           path
+//  Description:    Follows the next hops from a node to its goal.
+//  Arguments:      The node and the path to fill in, node first.
+//  Return Value:   false if no goal can be reached from the node.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+bool FlowField<ArcType, Cost, Queue>::path( int from, std::vector<int>& path ) const {
+    path.clear();
+    if( from < 0 || from >= (int)m_cost.size() || Traits::isInfinite( m_cost[from] ) ) {
+        return false;
+    }
+    for( int at = from; at != -1; at = m_next[at] ) {
+        path.push_back( at );
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           buildFlowFields
+//  Description:    Builds one field per goal, spread across threads.
+//                  Each field only reads the shared graph, so they
+//                  build independently.
+//  Arguments:      The graph, the goals, the fields to fill in and
+//                  the number of threads (0 for all cores).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+void buildFlowFields( CompactGraph<ArcType> const & graph, std::vector<int> const & goals,
+                      std::vector< FlowField<ArcType, Cost, Queue> >& fields, int threads = 0 ) {
+    fields.resize( goals.size() );
+    parallelFor( 0, (int)goals.size(), [&]( int lo, int hi, int ) {
+        for( int i = lo; i < hi; i++ ) {
+            fields[i].setGraph( graph );
+            fields[i].build( goals[i] );
+        }
+    }, threads, 1 );
+}
+
+// ----------------------------------------------------------------
+//  Name:           updateFlowFields
+//  Description:    Calls arcChanged on every field, across threads.
+//  Arguments:      The fields, the two ends of the changed arc and
+//                  the number of threads (0 for all cores).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType, class Cost, class Queue>
+void updateFlowFields( std::vector< FlowField<ArcType, Cost, Queue> >& fields, int from, int to, int threads = 0 ) {
+    parallelFor( 0, (int)fields.size(), [&]( int lo, int hi, int ) {
+        for( int i = lo; i < hi; i++ ) {
+            fields[i].arcChanged( from, to );
+        }
+    }, threads, 1 );
+}
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef FOOTPRINT_H
+#define FOOTPRINT_H
+
+#include <ostream>
+#include <iomanip>
+#include <list>
+#include <vector>
+#include "CompactGraph.h"
+#include "PackedGraph.h"
+
+// ----------------------------------------------------------------
+//  Name:           MemoryFootprint
+//  Description:    What one graph representation costs in memory,
+//                  for sizing servers and choosing a layout.
+//
+//                  nodeBytes and arcBytes are the storage that grows
+//                  with the nodes and with the arcs. slackBytes is
+//                  vector capacity reserved but unused, and
+//                  headerBytes the allocator's estimated header and
+//                  rounding for each of the blocks the layout is
+//                  spread over; together they are the space lost
+//                  to fragmentation. scratchBytes is the state a
+//                  search needs per query on top of the graph.
+// ----------------------------------------------------------------
+struct MemoryFootprint {
+    const char* name;
+    int nodes;
+    int arcs;
+    size_t nodeBytes;
+    size_t arcBytes;
+    size_t slackBytes;
+    size_t blocks;
+    size_t headerBytes;
+    size_t scratchBytes;
+
+    MemoryFootprint( const char* name = "" )
+        : name( name ), nodes( 0 ), arcs( 0 ), nodeBytes( 0 ), arcBytes( 0 ), slackBytes( 0 ),
+          blocks( 0 ), headerBytes( 0 ), scratchBytes( 0 ) {}
+
+    size_t total() const {
+        return nodeBytes + arcBytes + headerBytes;
+    }
+
+    double bytesPerNode() const {
+        return nodes > 0 ? (double)nodeBytes / nodes : 0.0;
+    }
+
+    double bytesPerArc() const {
+        return arcs > 0 ? (double)arcBytes / arcs : 0.0;
+    }
+
+    // Share of the total that holds nothing.
+    double fragmentation() const {
+        return total() > 0 ? (double)( slackBytes + headerBytes ) / total() : 0.0;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           heapBlockOverhead
+//  Description:    Estimated bytes the heap adds to an allocation:
+//                  a pointer-sized header, then rounding up to the
+//                  allocator's alignment of two pointers. This is
+//                  what both the MSVC and glibc heaps do for small
+//                  blocks.
+//  Arguments:      The size asked for.
+//  Return Value:   The extra bytes.
+// ----------------------------------------------------------------
+inline size_t heapBlockOverhead( size_t size ) {
+    const size_t align = 2 * sizeof( void* );
+    return ( size + sizeof( void* ) + align - 1 ) / align * align - size;
+}
+
+// ----------------------------------------------------------------
+//  Name:           searchScratchBytes
+//  Description:    Per-query arrays an AStarSearch sizes to the
+//                  graph: a cost and a parent per node and a closed
+//                  bit. The open list and the touched list grow
+//                  with the search on top of this; scratchBytes()
+//                  on a search that has run gives the real figure.
+//  Arguments:      The number of nodes.
+//  Return Value:   The size in bytes.
+// ----------------------------------------------------------------
+template<class Cost>
+size_t searchScratchBytes( int nodes ) {
+    return (size_t)nodes * ( sizeof( Cost ) + sizeof( int ) ) + nodes / 8;
+}
+
+// ----------------------------------------------------------------
+//  Name:           footprint
+//  Description:    Measures a Graph. Every node is its own block,
+//                  and so is every arc (a std::list node: the arc
+//                  plus two links). MSVC's std::list also allocates
+//                  an empty end node per list. The spatial index is
+//                  counted with the nodes. Heap owned inside the
+//                  SFML members (the text's glyph vertices) is not
+//                  visible from here and is left out.
+//
+//                  Graph::aStar keeps its search state in the nodes,
+//                  so the scratch is just the open list, which can
+//                  hold a pointer per arc.
+//  Arguments:      The graph.
+//  Return Value:   The footprint.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+MemoryFootprint footprint( Graph<NodeType, ArcType> const & graph ) {
+    typedef GraphNode<NodeType, ArcType> Node;
+    typedef GraphArc<NodeType, ArcType> Arc;
+    const size_t listNode = sizeof( Arc ) + 2 * sizeof( void* );
+
+    MemoryFootprint result( "Graph" );
+    result.nodeBytes = graph.maxNodes() * sizeof( Node* ) + graph.spatialIndex().bytes();
+    result.blocks = 1;
+    result.headerBytes = heapBlockOverhead( graph.maxNodes() * sizeof( Node* ) );
+
+    Node** pNodes = graph.nodeArray();
+    for( int i = 0; i < graph.maxNodes(); i++ ) {
+        if( pNodes[i] == 0 ) {
+            continue;
+        }
+        int arcs = (int)pNodes[i]->arcList().size();
+        result.nodes++;
+        result.arcs += arcs;
+        result.nodeBytes += sizeof( Node );
+        result.arcBytes += arcs * listNode;
+        result.blocks += 1 + arcs;
+        result.headerBytes += heapBlockOverhead( sizeof( Node ) ) + arcs * heapBlockOverhead( listNode );
+#ifdef _MSC_VER
+        result.nodeBytes += listNode;
+        result.blocks++;
+        result.headerBytes += heapBlockOverhead( listNode );
+#endif
+    }
+    result.scratchBytes = ( result.arcs + 1 ) * sizeof( Node* );
+    return result;
+}
+
+// ----------------------------------------------------------------
+//  Name:           footprint
+//  Description:    Measures a CompactGraph or a PackedGraph. Each
+//                  array is one block. The scratch is that of an
+//                  AStarSearch with the default cost type.
+//  Arguments:      The graph.
+//  Return Value:   The footprint.
+// ----------------------------------------------------------------
+template<class ArcType>
+MemoryFootprint footprint( CompactGraph<ArcType> const & graph ) {
+    MemoryFootprint result( "CompactGraph" );
+    result.nodes = graph.size();
+    result.arcs = graph.arcCount();
+    result.nodeBytes = graph.nodeBytes();
+    result.arcBytes = graph.arcBytes();
+    result.slackBytes = graph.slackBytes();
+    result.blocks = 7;
+    result.headerBytes = result.blocks * heapBlockOverhead( 0 );
+    result.scratchBytes = searchScratchBytes<ArcType>( graph.size() );
+    return result;
+}
+
+template<class ArcType>
+MemoryFootprint footprint( PackedGraph<ArcType> const & graph ) {
+    MemoryFootprint result( "PackedGraph" );
+    result.nodes = graph.size();
+    result.arcs = graph.arcCount();
+    result.nodeBytes = graph.nodeBytes();
+    result.arcBytes = graph.arcBytes();
+    result.slackBytes = graph.slackBytes();
+    result.blocks = 3;
+    result.headerBytes = result.blocks * heapBlockOverhead( 0 );
+    result.scratchBytes = searchScratchBytes<ArcType>( graph.size() );
+    return result;
+}
+
+// ----------------------------------------------------------------
+//  Name:           printFootprint
+//  Description:    Writes a footprint as one line of a table; call
+//                  printFootprintHeader first for the column names.
+//  Arguments:      The stream and the footprint.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void printFootprintHeader( std::ostream& out ) {
+    out << std::left << std::setw( 14 ) << "layout" << std::right
+        << std::setw( 10 ) << "nodes" << std::setw( 10 ) << "arcs"
+        << std::setw( 12 ) << "B/node" << std::setw( 10 ) << "B/arc"
+        << std::setw( 14 ) << "total KB" << std::setw( 10 ) << "blocks"
+        << std::setw( 8 ) << "frag" << std::setw( 14 ) << "scratch KB" << std::endl;
+}
+
+inline void printFootprint( std::ostream& out, MemoryFootprint const & footprint ) {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::left << std::setw( 14 ) << footprint.name << std::right
+        << std::setw( 10 ) << footprint.nodes << std::setw( 10 ) << footprint.arcs
+        << std::fixed << std::setprecision( 1 )
+        << std::setw( 12 ) << footprint.bytesPerNode() << std::setw( 10 ) << footprint.bytesPerArc()
+        << std::setw( 14 ) << footprint.total() / 1024.0 << std::setw( 10 ) << footprint.blocks
+        << std::setw( 7 ) << footprint.fragmentation() * 100.0 << "%"
+        << std::setw( 14 ) << footprint.scratchBytes / 1024.0 << std::endl;
+    out.flags( flags );
+    out.precision( precision );
+}
+
+#endif
@@ -3,12 +3,53 @@
 
 #include <list>
 #include <queue>
+#include <set>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include "SpatialGrid.h"
+#include "CostTraits.h"
 
 using namespace std;
 
 template <class NodeType, class ArcType> class GraphArc;
 template <class NodeType, class ArcType> class GraphNode;
 
+// ----------------------------------------------------------------
+//  Description:    The search modes that aStar can run in.
+//                  SEARCH_ASTAR    - plain A*, optimal path.
+//                  SEARCH_WEIGHTED - weighted A*, f = g + w*h.
+//                  SEARCH_FOCAL    - focal search (A*epsilon).
+//                  With a consistent h(n) both suboptimal modes
+//                  return a path costing at most w times the
+//                  optimal path.
+// ----------------------------------------------------------------
+enum SearchMode { SEARCH_ASTAR, SEARCH_WEIGHTED, SEARCH_FOCAL };
+
+// ----------------------------------------------------------------
+//  Name:           NullVisitor
+//  Description:    The default visitor for the traversals. Every
+//                  event is an empty inline function, so a search
+//                  run without a visitor has no per-node calls left
+//                  after inlining. Derive from it and hide only the
+//                  events you need.
+//                  discover( node )         - node reached (marked).
+//                  expand( node )           - node's arcs about to
+//                                             be followed.
+//                  relax( from, to, cost )  - cheaper cost found for
+//                                             to, through from.
+//                  finish( node )           - node is done.
+//                  depthFirst sends discover/finish, breadthFirst
+//                  discover/expand/finish, the searches all four.
+// ----------------------------------------------------------------
+struct NullVisitor {
+    template<class Node> void discover( Node* ) {}
+    template<class Node> void expand( Node* ) {}
+    template<class Node, class Cost> void relax( Node*, Node*, Cost ) {}
+    template<class Node> void finish( Node* ) {}
+};
+
 // ----------------------------------------------------------------
 //  Name:           Graph
 //  Description:    This is the graph class, it contains all the
@@ -38,6 +79,13 @@ private:
 // ----------------------------------------------------------------
     int m_count;
 
+// ----------------------------------------------------------------
+//  Description:    Node positions, bucketed for nearest-node and
+//                  area queries. Kept up to date by addNode and
+//                  removeNode.
+// ----------------------------------------------------------------
+    SpatialGrid m_spatial;
+
 
 public:           
     // Constructor and destructor functions
@@ -49,28 +97,59 @@ public:
        return m_pNodes;
     }
 
+    int maxNodes() const {
+       return m_maxNodes;
+    }
+
+    int count() const {
+       return m_count;
+    }
+
+    SpatialGrid const & spatialIndex() const {
+       return m_spatial;
+    }
+
     // Public member functions.
-    bool addNode( NodeType data, int index , sf::Vector2f p_pos, sf::Font p_font);
+    bool addNode( NodeType data, int index , sf::Vector2f p_pos, sf::Font const & p_font);
     void removeNode( int index );
     bool addArc( int from, int to, ArcType weight);
     void removeArc( int from, int to );
     Arc* getArc( int from, int to );        
     void clearMarks();
-    void depthFirst( Node* pNode, void (*pProcess)(Node*) );
-    void breadthFirst( Node* pNode, void (*pProcess)(Node*) );
+    Node* nearestNode( sf::Vector2f position, float maxDistance = -1.0f ) const;
+    template<class Visitor = NullVisitor>
+    void depthFirst( Node* pNode, Visitor&& visitor = Visitor() );
+    template<class Visitor = NullVisitor>
+    void breadthFirst( Node* pNode, Visitor&& visitor = Visitor() );
 	void adaptedBreadthFirst( Node* pCurrent, Node* pGoal );	
-	void aStar(Node* pStart, Node* pDest, void(*pProcess)(Node*), std::vector<Node *>& path);
+	template<class Visitor = NullVisitor>
+	void aStar(Node* pStart, Node* pDest, std::vector<Node *>& path, Visitor&& visitor = Visitor());
+	template<class Visitor = NullVisitor>
+	void aStar(Node* pStart, Node* pDest, std::vector<Node *>& path, SearchMode mode, float weight, Visitor&& visitor = Visitor());
+	template<class Visitor = NullVisitor>
+	void weightedAStar(Node* pStart, Node* pDest, std::vector<Node *>& path, float weight, Visitor&& visitor = Visitor());
+	template<class Visitor = NullVisitor>
+	void focalSearch(Node* pStart, Node* pDest, std::vector<Node *>& path, float weight, Visitor&& visitor = Visitor());
 
 	// Updated Functor - Includes heuristics in search
 	//////////////////////////
 	class NodeSearchCostComparer {
 	public:
 		bool operator()(Node * n1, Node * n2) {
-			tuple<string, int, int> p1 = n1->data();
-			tuple<string, int, int> p2 = n2->data();
-			return get<1>(p1) +get<2>(p1) > get<1>(p2) +get<2>(p2);
+			NodeType const & p1 = n1->data();
+			NodeType const & p2 = n2->data();
+			return CostTraits<ArcType>::add(get<1>(p1), get<2>(p1)) > CostTraits<ArcType>::add(get<1>(p2), get<2>(p2));
 		}
 	};
+
+private:
+	// (priority, node index) pair used by the bounded searches.
+	typedef pair<float, int> SearchEntry;
+
+	// (f, node index) pair used by aStar, kept in exact cost units.
+	typedef pair<ArcType, int> CostEntry;
+
+	void buildPath(Node* pStart, Node* pDest, std::vector<Node *>& path);
 };
 
 // ----------------------------------------------------------------
@@ -118,7 +197,7 @@ Graph<NodeType, ArcType>::~Graph() {
 //  Return Value:   true if successful
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-bool Graph<NodeType, ArcType>::addNode( NodeType data, int index, sf::Vector2f p_pos, sf::Font p_font ) {
+bool Graph<NodeType, ArcType>::addNode( NodeType data, int index, sf::Vector2f p_pos, sf::Font const & p_font ) {
    bool nodeNotPresent = false;
    // find out if a node does not exist at that index.
    if ( m_pNodes[index] == 0) {
@@ -127,8 +206,10 @@ bool Graph<NodeType, ArcType>::addNode( NodeType data, int index, sf::Vector2f p
       m_pNodes[index] = new Node;
       m_pNodes[index]->setData(data);
       m_pNodes[index]->setMarked(false);
+      m_pNodes[index]->setIndex(index);
 	  m_pNodes[index]->SetPosition(p_pos);
 	  m_pNodes[index]->SetUpNode(p_font);
+      m_spatial.insert( index, p_pos );
       // increase the count and return success.
       m_count++;
     }
@@ -153,6 +234,7 @@ void Graph<NodeType, ArcType>::removeNode( int index ) {
 
          // loop through every node
          for( node = 0; node < m_maxNodes; node++ ) {
+              arc = 0;
               // if the node is valid...
               if( m_pNodes[node] != 0 ) {
                   // see if the node has an arc pointing to the current node.
@@ -170,6 +252,7 @@ void Graph<NodeType, ArcType>::removeNode( int index ) {
         // the node can be deleted.
         delete m_pNodes[index];
         m_pNodes[index] = 0;
+        m_spatial.remove( index );
         m_count--;
     }
 }
@@ -192,7 +275,7 @@ bool Graph<NodeType, ArcType>::addArc( int from, int to, ArcType weight ) {
      }
         
      // if an arc already exists we should not proceed
-     if( m_pNodes[from]->getArc( m_pNodes[to] ) != 0 ) {
+     else if( m_pNodes[from]->getArc( m_pNodes[to] ) != 0 ) {
          proceed = false;
      }
 
@@ -265,30 +348,63 @@ void Graph<NodeType, ArcType>::clearMarks() {
 }
 
 
+// ----------------------------------------------------------------
+//  Name:           nearestNode
+//  Description:    Snaps a world position to the closest node, using
+//                  the spatial index rather than checking every node.
+//  Arguments:      The position, and the furthest away the node may
+//                  be (negative for no limit).
+//  Return Value:   The node, or 0 if none is close enough.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+GraphNode<NodeType, ArcType>* Graph<NodeType, ArcType>::nearestNode( sf::Vector2f position, float maxDistance ) const {
+     int index = m_spatial.nearest( position, maxDistance );
+     return index == -1 ? 0 : m_pNodes[index];
+}
+
+
 // ----------------------------------------------------------------
 //  Name:           depthFirst
 //  Description:    Performs a depth-first traversal on the specified 
-//                  node.
+//                  node. The nodes on the current path are kept on
+//                  an explicit stack, so long chains of nodes
+//                  cannot overflow the call stack.
 //  Arguments:      The first argument is the starting node
-//                  The second argument is the processing function.
+//                  The second argument is the visitor.
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-void Graph<NodeType, ArcType>::depthFirst( Node* pNode, void (*pProcess)(Node*) ) {
+template<class Visitor>
+void Graph<NodeType, ArcType>::depthFirst( Node* pNode, Visitor&& visitor ) {
      if( pNode != 0 ) {
-           // process the current node and mark it
-           pProcess( pNode );
-           pNode->setMarked(true);
+           typedef typename list<Arc>::const_iterator ArcIter;
+           // each entry is a node and the next of its arcs to follow.
+           vector< pair<Node*, ArcIter> > nodeStack;
 
-           // go through each connecting node
-           list<Arc>::iterator iter = pNode->arcList().begin();
-           list<Arc>::iterator endIter = pNode->arcList().end();
-        
-		   for( ; iter != endIter; ++iter) {
-			    // process the linked node if it isn't already marked.
-                if ( (*iter).node()->marked() == false ) {
-                   depthFirst( (*iter).node(), pProcess);
-                }            
+           // process the first node and mark it
+           visitor.discover( pNode );
+           pNode->setMarked(true);
+           nodeStack.push_back( make_pair( pNode, pNode->arcList().begin() ) );
+
+           while( nodeStack.size() != 0 ) {
+                Node* pCurrent = nodeStack.back().first;
+                ArcIter& iter = nodeStack.back().second;
+
+                if( iter == pCurrent->arcList().end() ) {
+                    // every connecting node is done, go back up.
+                    nodeStack.pop_back();
+                    visitor.finish( pCurrent );
+                }
+                else {
+                    Node* pChild = (*iter).node();
+                    ++iter;
+                    // process the linked node if it isn't already marked.
+                    if ( pChild->marked() == false ) {
+                        visitor.discover( pChild );
+                        pChild->setMarked(true);
+                        nodeStack.push_back( make_pair( pChild, pChild->arcList().begin() ) );
+                    }
+                }
            }
      }
 }
@@ -299,21 +415,23 @@ void Graph<NodeType, ArcType>::depthFirst( Node* pNode, void (*pProcess)(Node*)
 //  Description:    Performs a depth-first traversal the starting node
 //                  specified as an input parameter.
 //  Arguments:      The first parameter is the starting node
-//                  The second parameter is the processing function.
+//                  The second parameter is the visitor.
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-void Graph<NodeType, ArcType>::breadthFirst( Node* pNode, void (*pProcess)(Node*) ) {
+template<class Visitor>
+void Graph<NodeType, ArcType>::breadthFirst( Node* pNode, Visitor&& visitor ) {
    if( pNode != 0 ) {
 	  queue<Node*> nodeQueue;        
 	  // place the first node on the queue, and mark it.
       nodeQueue.push( pNode );
       pNode->setMarked(true);
+      visitor.discover( pNode );
 
       // loop through the queue while there are nodes in it.
       while( nodeQueue.size() != 0 ) {
          // process the node at the front of the queue.
-         pProcess( nodeQueue.front() );
+         visitor.expand( nodeQueue.front() );
 
          // add all of the child nodes that have not been 
          // marked into the queue
@@ -325,10 +443,12 @@ void Graph<NodeType, ArcType>::breadthFirst( Node* pNode, void (*pProcess)(Node*
 				 // mark the node and add it to the queue.
                  (*iter).node()->setMarked(true);
                  nodeQueue.push( (*iter).node() );
+                 visitor.discover( (*iter).node() );
               }
          }
 
          // dequeue the current node.
+         visitor.finish( nodeQueue.front() );
          nodeQueue.pop();
       }
    }  
@@ -410,108 +530,350 @@ void Graph<NodeType, ArcType>::adaptedBreadthFirst( Node* pCurrent, Node *pGoal
  If h(n) < cost of moving - Not guaranteed to find the fastest path but it can run faster.
 */
 
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    Plain A*, optimal for any h(n) that never
+//                  overestimates. Per-query costs and a closed
+//                  bitmap are kept by node index; the queue holds
+//                  (f, node) entries and an entry is dropped when it
+//                  is popped if the node has since been pushed again
+//                  more cheaply or is already closed, so nothing is
+//                  ever searched for inside the queue.
+//
+//                  While every arc seen so far satisfies
+//                  h(n) <= weight + h(child) (a consistent h, such
+//                  as the straight line distance) a closed node's
+//                  cost is final, and closed children are skipped
+//                  without being costed: no node is expanded twice.
+//                  Once an arc breaks that, a closed node reached
+//                  more cheaply is re-opened, which keeps the path
+//                  optimal for an h that is admissible only.
+//                  h(n) is read from the third element of the node
+//                  data; g(n) is written into the second.
+//  Arguments:      Start node, goal node, the path to fill in and
+//                  the visitor.
+//  Return Value:   None.
+// ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-void Graph<NodeType, ArcType>::aStar(Node* pStart, Node* pDest, void(*pProcess)(Node*), std::vector<Node *>& path)
+template<class Visitor>
+void Graph<NodeType, ArcType>::aStar(Node* pStart, Node* pDest, std::vector<Node *>& path, Visitor&& visitor)
 {
-	// Set up Priority Queue
-	priority_queue<Node *, vector<Node *>, NodeSearchCostComparer> pq;
+	if (pStart == 0 || pDest == 0)
+		return;
 
-	// Add the start node to the queue
-	pq.push(pStart);
+	// Per-query costs and closed flags, indexed by node index
+	std::vector<ArcType> gCost(m_maxNodes, CostTraits<ArcType>::infinity());
+	std::vector<bool> closed(m_maxNodes, false);
+	priority_queue<CostEntry, vector<CostEntry>, greater<CostEntry> > pq;
+	bool consistent = true;
 
-	// Set the start nodes cost data to 0
+	gCost[pStart->index()] = 0;
 	pStart->setData(NodeType(get<0>(pStart->data()), 0, get<2>(pStart->data())));
-	
-	// Mark the first node
 	pStart->setMarked(true);
-	
-	// EXTRA - Set a string for the data to be printed on the node
-	pStart->SetText("    " + (get<0>(pStart->data())) + "\n" + " C-" + std::to_string((get<1>(pStart->data()))) + "\n" + " H-" + std::to_string((get<2>(pStart->data()))));
-
+	visitor.discover(pStart);
+	pq.push(CostEntry(CostTraits<ArcType>::add(0, get<2>(pStart->data())), pStart->index()));
 
-	// While the priority queue is not empty and top node of the pq is not equal to the end node
-	while (pq.size() != 0 && pq.top() != pDest)
+	while (pq.size() != 0)
 	{
-		// Iterator
-		list<Arc>::const_iterator iter = pq.top()->arcList().begin();
-		list<Arc>::const_iterator endIter = pq.top()->arcList().end();
+		ArcType f = pq.top().first;
+		int current = pq.top().second;
+		pq.pop();
+
+		// Drop entries left behind by a cheaper push, or for closed nodes
+		Node* pCurrent = m_pNodes[current];
+		if (closed[current] || f != CostTraits<ArcType>::add(gCost[current], get<2>(pCurrent->data())))
+			continue;
+		closed[current] = true;
+
+		if (pCurrent == pDest)
+			break;
+		visitor.expand(pCurrent);
+
+		ArcType hCurrent = get<2>(pCurrent->data());
+		typename list<Arc>::const_iterator iter = pCurrent->arcList().begin();
+		typename list<Arc>::const_iterator endIter = pCurrent->arcList().end();
 
-		// Loop through all the connecting nodes in the arc list
 		for (; iter != endIter; iter++)
 		{
-			if ((*iter).node() != pq.top()->previous())
+			Node* pChild = (*iter).node();
+			int child = pChild->index();
+			ArcType hChild = get<2>(pChild->data());
+
+			// Watch for an arc the heuristic drops by more than its weight
+			if (consistent && hCurrent > CostTraits<ArcType>::add(hChild, (*iter).weight()))
+				consistent = false;
+			if (closed[child] && consistent)
+				continue;
+
+			ArcType gNew = CostTraits<ArcType>::add(gCost[current], (*iter).weight());
+			if (gNew < gCost[child])
 			{
-				// Heuristic Cost
-				int hCost = get<2>(pq.top()->data());
+				// only reached for a closed node when h is inconsistent
+				closed[child] = false;
+				gCost[child] = gNew;
+				pChild->setData(NodeType(get<0>(pChild->data()), gNew, hChild));
+				pChild->setPrevious(pCurrent);
+				visitor.relax(pCurrent, pChild, gNew);
+				pq.push(CostEntry(CostTraits<ArcType>::add(gNew, hChild), child));
+
+				if (!pChild->marked())
+				{
+					pChild->setMarked(true);
+					visitor.discover(pChild);
+				}
+			}
+		}
+		visitor.finish(pCurrent);
+	}
+
+	if (closed[pDest->index()])
+		buildPath(pStart, pDest, path);
+}
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    Runs the search selected by mode. The weight is
+//                  the suboptimality bound for the weighted and
+//                  focal modes and is ignored by plain A*.
+//  Arguments:      Start node, goal node, the path to fill in, the
+//                  search mode, the weight and the visitor.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Visitor>
+void Graph<NodeType, ArcType>::aStar(Node* pStart, Node* pDest, std::vector<Node *>& path, SearchMode mode, float weight, Visitor&& visitor)
+{
+	switch (mode)
+	{
+	case SEARCH_WEIGHTED:
+		weightedAStar(pStart, pDest, path, weight, visitor);
+		break;
+	case SEARCH_FOCAL:
+		focalSearch(pStart, pDest, path, weight, visitor);
+		break;
+	default:
+		aStar(pStart, pDest, path, visitor);
+		break;
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           weightedAStar
+//  Description:    Weighted A*. Nodes are expanded in order of
+//                  f(n) = g(n) + w * h(n), which pushes the search
+//                  towards the goal and expands far fewer nodes.
+//                  Closed nodes are never re-opened; with a
+//                  consistent h(n) the path found still costs at
+//                  most w times the optimal path.
+//                  h(n) is read from the third element of the node
+//                  data, exactly like aStar.
+//  Arguments:      Start node, goal node, the path to fill in, the
+//                  weight w (>= 1) and the visitor.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Visitor>
+void Graph<NodeType, ArcType>::weightedAStar(Node* pStart, Node* pDest, std::vector<Node *>& path, float weight, Visitor&& visitor)
+{
+	if (pStart == 0 || pDest == 0)
+		return;
 
-				// Total Weight Cost
-				int gCost = get<1>(pq.top()->data()) + (*iter).weight();
+	// A weight below 1 would only slow the search down
+	if (weight < 1.0f)
+		weight = 1.0f;
 
-				// Total Cost
-				int distC = gCost + hCost;
+	// Per-query costs, indexed by node index
+	std::vector<ArcType> gCost(m_maxNodes, CostTraits<ArcType>::infinity());
+	std::vector<bool> closed(m_maxNodes, false);
+	priority_queue<SearchEntry, vector<SearchEntry>, greater<SearchEntry> > pq;
 
-				// Childs Total Cost
-				int currF = get<1>((*iter).node()->data()) + get<2>((*iter).node()->data());
+	gCost[pStart->index()] = 0;
+	pStart->setData(NodeType(get<0>(pStart->data()), 0, get<2>(pStart->data())));
+	pStart->setMarked(true);
+	visitor.discover(pStart);
+	pq.push(SearchEntry(weight * get<2>(pStart->data()), pStart->index()));
 
-				// if the pq.top nodes total cost, is less than the connecting nodes total cost
-				if (distC < currF)
-				{
-					// Update the connecting nodes total cost
-					(*iter).node()->setData(NodeType(get<0>((*iter).node()->data()), gCost, get<2>((*iter).node()->data())));
+	while (pq.size() != 0)
+	{
+		int current = pq.top().second;
+		pq.pop();
 
-					// Set the connecting nodes previous to the top of the priority queue
-					(*iter).node()->setPrevious(pq.top());
+		// Skip entries left behind by a cheaper push of the same node
+		if (closed[current])
+			continue;
+		closed[current] = true;
 
-					// EXTRA - setting values to be seen on the node
-					(*iter).node()->SetText("    " + (get<0>((*iter).node()->data())) + "\n" + " C-" + std::to_string(gCost) + "\n" + " H-" + std::to_string((get<2>((*iter).node()->data()))));
-				}
-				// If the connecting node is not marked
-				if (!(*iter).node()->marked())
-				{
-					// Push it to the priority queue
-					pq.push((*iter).node());
+		Node* pCurrent = m_pNodes[current];
+		if (pCurrent == pDest)
+			break;
+		visitor.expand(pCurrent);
+
+		typename list<Arc>::const_iterator iter = pCurrent->arcList().begin();
+		typename list<Arc>::const_iterator endIter = pCurrent->arcList().end();
+
+		for (; iter != endIter; iter++)
+		{
+			Node* pChild = (*iter).node();
+			int child = pChild->index();
+			if (closed[child])
+				continue;
 
-					// Mark the node
-					(*iter).node()->setMarked(true);
+			ArcType gNew = CostTraits<ArcType>::add(gCost[current], (*iter).weight());
+			if (gNew < gCost[child])
+			{
+				gCost[child] = gNew;
+				pChild->setData(NodeType(get<0>(pChild->data()), gNew, get<2>(pChild->data())));
+				pChild->setPrevious(pCurrent);
+				visitor.relax(pCurrent, pChild, gNew);
+				pq.push(SearchEntry(gNew + weight * get<2>(pChild->data()), child));
 
-					// EXTRA - Change color of the node as to show it has been marked
-					(*iter).node()->SetColor(sf::Color(0, 0, 255));
+				if (!pChild->marked())
+				{
+					pChild->setMarked(true);
+					visitor.discover(pChild);
 				}
 			}
 		}
-		// Pop from the prioriy queue
-		pq.pop();
+		visitor.finish(pCurrent);
 	}
-	// Printy out function
-	//////////////////////////
-	if (pq.size() != 0 && pq.top() == pDest)
+
+	if (closed[pDest->index()])
+		buildPath(pStart, pDest, path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           focalSearch
+//  Description:    Focal search (A*epsilon). The open list is kept
+//                  ordered by f(n) = g(n) + h(n). Every open node
+//                  with f(n) <= w * fmin is also kept in the focal
+//                  list, ordered by h(n) alone, and the node closest
+//                  to the goal is expanded from there. Closed nodes
+//                  are never re-opened; with a consistent h(n) the
+//                  path found costs at most w times the optimal
+//                  path.
+//  Arguments:      Start node, goal node, the path to fill in, the
+//                  weight w (>= 1) and the visitor.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Visitor>
+void Graph<NodeType, ArcType>::focalSearch(Node* pStart, Node* pDest, std::vector<Node *>& path, float weight, Visitor&& visitor)
+{
+	if (pStart == 0 || pDest == 0)
+		return;
+
+	if (weight < 1.0f)
+		weight = 1.0f;
+
+	std::vector<ArcType> gCost(m_maxNodes, CostTraits<ArcType>::infinity());
+	std::vector<float> fCost(m_maxNodes, 0.0f);
+	std::vector<bool> inOpen(m_maxNodes, false);
+	std::vector<bool> closed(m_maxNodes, false);
+
+	// open is ordered by f, focal by h; focal is a subset of open
+	set<SearchEntry> open;
+	set<SearchEntry> focal;
+
+	gCost[pStart->index()] = 0;
+	fCost[pStart->index()] = (float)get<2>(pStart->data());
+	pStart->setData(NodeType(get<0>(pStart->data()), 0, get<2>(pStart->data())));
+	pStart->setMarked(true);
+	visitor.discover(pStart);
+	open.insert(SearchEntry(fCost[pStart->index()], pStart->index()));
+	focal.insert(SearchEntry((float)get<2>(pStart->data()), pStart->index()));
+	inOpen[pStart->index()] = true;
+
+	while (focal.size() != 0)
 	{
-		// Looping backwards while the pDest != 0
-		//////////////////////////
-		for (Node *a = pDest; a->previous() != 0; a = a->previous())
+		float oldBound = weight * open.begin()->first;
+
+		// Take the open node closest to the goal inside the bound
+		int current = focal.begin()->second;
+		focal.erase(focal.begin());
+		open.erase(SearchEntry(fCost[current], current));
+		inOpen[current] = false;
+		closed[current] = true;
+
+		Node* pCurrent = m_pNodes[current];
+		if (pCurrent == pDest)
+			break;
+		visitor.expand(pCurrent);
+
+		typename list<Arc>::const_iterator iter = pCurrent->arcList().begin();
+		typename list<Arc>::const_iterator endIter = pCurrent->arcList().end();
+
+		for (; iter != endIter; iter++)
 		{
-			// Push back the path
-			//////////////////////////
-			path.push_back(a);
-			a->SetColor(sf::Color(255, 0, 0));
+			Node* pChild = (*iter).node();
+			int child = pChild->index();
+			if (closed[child])
+				continue;
+
+			ArcType gNew = CostTraits<ArcType>::add(gCost[current], (*iter).weight());
+			if (gNew < gCost[child])
+			{
+				float hChild = (float)get<2>(pChild->data());
+
+				// Drop the old entries before re-inserting with the new cost
+				if (inOpen[child])
+				{
+					open.erase(SearchEntry(fCost[child], child));
+					focal.erase(SearchEntry(hChild, child));
+				}
+
+				gCost[child] = gNew;
+				fCost[child] = gNew + hChild;
+				open.insert(SearchEntry(fCost[child], child));
+				inOpen[child] = true;
+				if (fCost[child] <= oldBound)
+					focal.insert(SearchEntry(hChild, child));
+
+				pChild->setData(NodeType(get<0>(pChild->data()), gNew, get<2>(pChild->data())));
+				pChild->setPrevious(pCurrent);
+				visitor.relax(pCurrent, pChild, gNew);
+
+				if (!pChild->marked())
+				{
+					pChild->setMarked(true);
+					visitor.discover(pChild);
+				}
+			}
+		}
+		visitor.finish(pCurrent);
 
-			if (a == pDest)
-				a->SetColor(sf::Color(150, 0, 150));
+		if (open.size() == 0)
+			break;
 
+		// fmin may have moved, pull newly qualifying nodes into focal.
+		// Only nodes past the old bound can be new to it, unless focal
+		// has run dry and must be refilled from the front of open
+		float newBound = weight * open.begin()->first;
+		if (newBound > oldBound || focal.size() == 0)
+		{
+			typename set<SearchEntry>::const_iterator it = focal.size() == 0 ? open.begin()
+				: open.upper_bound(SearchEntry(oldBound, numeric_limits<int>::max()));
+			for (; it != open.end() && it->first <= newBound; ++it)
+				focal.insert(SearchEntry((float)get<2>(m_pNodes[it->second]->data()), it->second));
 		}
-		// Get the start Path
-		//////////////////////////
-		path.push_back(pStart);
-
-		// Reverse the path " Didn't think of this the last time"
-		//////////////////////////
-		std::reverse(path.begin(), path.end());
-
-		// Print the path
-		//////////////////////////
-		for (int i = 0; i < path.size(); i++)
-			pProcess(path.at(i));
 	}
+
+	if (closed[pDest->index()])
+		buildPath(pStart, pDest, path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           buildPath
+//  Description:    Follows the previous pointers back from the goal
+//                  and fills in the path from start to goal.
+//  Arguments:      Start node, goal node and the path to fill in.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void Graph<NodeType, ArcType>::buildPath(Node* pStart, Node* pDest, std::vector<Node *>& path)
+{
+	for (Node *a = pDest; a != pStart && a != 0; a = a->previous())
+		path.push_back(a);
+	path.push_back(pStart);
+	std::reverse(path.begin(), path.end());
 }
 /*
 template<class NodeType, class ArcType>
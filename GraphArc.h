@@ -22,7 +22,6 @@ private:
 // Description: Weight of the arc
 // -------------------------------------------------------
     ArcType m_weight;
-	sf::Vertex m_line[2];
 
 public:    
     
@@ -43,19 +42,6 @@ public:
 	void setWeight(ArcType weight) {
 		m_weight = weight;
 	}
-
-	void setLine(sf::Vector2f startPos, sf::Vector2f endPos)
-	{
-		m_line[0] = startPos;
-		m_line[1] = endPos;
-	}
-
-	void Draw(sf::RenderTarget &p_window)
-	{
-		p_window.draw(m_line, 2, sf::Lines);
-	}
-
-
 };
 
 #endif
@@ -0,0 +1,479 @@
+#ifndef GRAPHLOADER_H
+#define GRAPHLOADER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ostream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include "Parallel.h"
+
+// ----------------------------------------------------------------
+//  Name:           NodeRecord / ArcRecord
+//  Description:    One line of nodes.txt ("name x y") and one line
+//                  of arcs.txt ("from to weight").
+// ----------------------------------------------------------------
+struct NodeRecord {
+    std::string name;
+    int x;
+    int y;
+};
+
+struct ArcRecord {
+    int from;
+    int to;
+    int weight;
+};
+
+// ----------------------------------------------------------------
+//  Name:           RecordDistance
+//  Description:    Heuristic from the node file's positions: the
+//                  straight line distance to the goal, times scale.
+// ----------------------------------------------------------------
+struct RecordDistance {
+    std::vector<NodeRecord> const & m_nodes;
+    int m_goal;
+    double m_scale;
+
+    RecordDistance( std::vector<NodeRecord> const & nodes, int goal, double scale )
+        : m_nodes( nodes ), m_goal( goal ), m_scale( scale ) {}
+
+    double operator()( int node ) const {
+        double dx = (double)m_nodes[node].x - m_nodes[m_goal].x;
+        double dy = (double)m_nodes[node].y - m_nodes[m_goal].y;
+        return m_scale * std::sqrt( dx * dx + dy * dy );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           consistentScale
+//  Description:    The largest RecordDistance scale, at most 1, that
+//                  is consistent on a graph: the smallest ratio of an
+//                  arc's weight to the straight line between its
+//                  ends, less a hair for rounding. Files whose
+//                  weights are rounded-down lengths come out just
+//                  under 1. A consistent heuristic is what the radix
+//                  heap and bucket queue need (see PriorityQueues.h).
+//  Arguments:      The node records and the graph built from them.
+//  Return Value:   The scale.
+// ----------------------------------------------------------------
+template<class GraphType>
+double consistentScale( std::vector<NodeRecord> const & nodes, GraphType const & graph ) {
+    double scale = 1.0;
+    for( int from = 0; from < graph.size() && from < (int)nodes.size(); from++ ) {
+        for( int a = graph.begin( from ); a < graph.end( from ); a++ ) {
+            int to = graph.target( a );
+            double dx = (double)nodes[from].x - nodes[to].x;
+            double dy = (double)nodes[from].y - nodes[to].y;
+            double length = std::sqrt( dx * dx + dy * dy );
+            if( (double)graph.weight( a ) < scale * length ) {
+                scale = (double)graph.weight( a ) / length;
+            }
+        }
+    }
+    return scale * ( 1.0 - 1e-9 );
+}
+
+// ----------------------------------------------------------------
+//  Name:           LoadError
+//  Description:    A line that could not be read, by line number.
+// ----------------------------------------------------------------
+struct LoadError {
+    long long line;
+    std::string message;
+};
+
+// ----------------------------------------------------------------
+//  Name:           LoadErrors
+//  Description:    The malformed lines found while loading. Only the
+//                  first MAXREPORTED are kept so a file of the wrong
+//                  format cannot fill memory with messages; count()
+//                  still gives the total.
+// ----------------------------------------------------------------
+class LoadErrors {
+private:
+    enum { MAXREPORTED = 100 };
+
+    std::vector<LoadError> m_errors;
+    long long m_count;
+
+public:
+    LoadErrors() : m_count( 0 ) {}
+
+    void add( long long line, std::string const & message ) {
+        if( m_errors.size() < MAXREPORTED ) {
+            LoadError error = { line, message };
+            m_errors.push_back( error );
+        }
+        m_count++;
+    }
+
+    void append( LoadErrors const & other ) {
+        for( int i = 0; i < (int)other.m_errors.size(); i++ ) {
+            add( other.m_errors[i].line, other.m_errors[i].message );
+        }
+        m_count += other.m_count - (long long)other.m_errors.size();
+    }
+
+    // Accessors
+    long long count() const {
+        return m_count;
+    }
+
+    std::vector<LoadError> const & errors() const {
+        return m_errors;
+    }
+
+    // Writes "Line n: message" for each kept error, then how many
+    // more there were.
+    void print( std::ostream& out ) const {
+        for( int i = 0; i < (int)m_errors.size(); i++ ) {
+            out << "Line " << m_errors[i].line << ": " << m_errors[i].message << std::endl;
+        }
+        if( m_count > (long long)m_errors.size() ) {
+            out << m_count - (long long)m_errors.size() << " more bad lines" << std::endl;
+        }
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           LineParser
+//  Description:    Reads whitespace separated fields from one line
+//                  of text. Numbers are parsed by hand rather than
+//                  with streams, which check the locale for every
+//                  character, or strtol, which needs a terminated
+//                  string.
+// ----------------------------------------------------------------
+class LineParser {
+private:
+    const char* m_pos;
+    const char* m_end;
+
+public:
+    LineParser( const char* begin, const char* end ) : m_pos( begin ), m_end( end ) {}
+
+    void skipSpace() {
+        while( m_pos != m_end && ( *m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r' ) ) {
+            m_pos++;
+        }
+    }
+
+    // true when only whitespace is left.
+    bool atEnd() {
+        skipSpace();
+        return m_pos == m_end;
+    }
+
+    // Reads the next run of non-whitespace characters.
+    bool readWord( std::string& word ) {
+        skipSpace();
+        const char* start = m_pos;
+        while( m_pos != m_end && *m_pos != ' ' && *m_pos != '\t' && *m_pos != '\r' ) {
+            m_pos++;
+        }
+        word.assign( start, m_pos );
+        return m_pos != start;
+    }
+
+    // Reads a whole number. Fails on a missing number, an overflow
+    // or a number followed by anything but whitespace ("12ab").
+    bool readInt( int& value ) {
+        skipSpace();
+        bool negative = false;
+        if( m_pos != m_end && ( *m_pos == '-' || *m_pos == '+' ) ) {
+            negative = *m_pos == '-';
+            m_pos++;
+        }
+        const char* start = m_pos;
+        long long result = 0;
+        while( m_pos != m_end && *m_pos >= '0' && *m_pos <= '9' ) {
+            result = result * 10 + ( *m_pos - '0' );
+            if( result > 2147483648LL ) {
+                return false;
+            }
+            m_pos++;
+        }
+        if( m_pos == start || ( m_pos != m_end && *m_pos != ' ' && *m_pos != '\t' && *m_pos != '\r' ) ) {
+            return false;
+        }
+        if( negative ) {
+            result = -result;
+        }
+        if( result > 2147483647LL ) {
+            return false;
+        }
+        value = (int)result;
+        return true;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           readChunks
+//  Description:    Reads a file in large blocks and hands each block
+//                  to process( begin, end, firstLine ), cut after the
+//                  last complete line. The rest of the block is
+//                  carried into the next read, so only one block is
+//                  ever in memory whatever the size of the file.
+//                  A line longer than a block grows the block.
+//  Arguments:      The file, the processing function and the block
+//                  size in bytes.
+//  Return Value:   false if the file could not be opened.
+// ----------------------------------------------------------------
+template<class Process>
+bool readChunks( const char* path, Process process, int chunkBytes = 1 << 22 ) {
+    std::ifstream file( path, std::ios::in | std::ios::binary );
+    if( !file ) {
+        return false;
+    }
+    std::vector<char> buffer( chunkBytes );
+    size_t used = 0;
+    long long line = 1;
+
+    while( true ) {
+        if( used == buffer.size() ) {
+            buffer.resize( buffer.size() * 2 );
+        }
+        file.read( &buffer[used], buffer.size() - used );
+        used += (size_t)file.gcount();
+        bool done = !file;
+
+        // cut after the last newline, or take everything at the end.
+        size_t cut = used;
+        if( !done ) {
+            while( cut > 0 && buffer[cut - 1] != '\n' ) {
+                cut--;
+            }
+            if( cut == 0 ) {
+                continue;
+            }
+        }
+        if( cut > 0 ) {
+            process( (const char*)&buffer[0], (const char*)&buffer[0] + cut, line );
+            line += std::count( buffer.begin(), buffer.begin() + cut, '\n' );
+            std::memmove( &buffer[0], &buffer[0] + cut, used - cut );
+            used -= cut;
+        }
+        if( done ) {
+            break;
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           parseLines
+//  Description:    Runs parseLine over every line in [begin, end).
+//                  parseLine( parser, record, message ) returns 1 for
+//                  a record, 0 for a blank line and -1 for a bad
+//                  line, setting message to say why.
+//  Arguments:      The text, the number of its first line, the line
+//                  parser and where to put the records and errors.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Record, class ParseLine>
+void parseLines( const char* begin, const char* end, long long line, ParseLine const & parseLine, std::vector<Record>& records, LoadErrors& errors ) {
+    Record record;
+    const char* message = "";
+    while( begin != end ) {
+        const char* lineEnd = std::find( begin, end, '\n' );
+        LineParser parser( begin, lineEnd );
+        int result = parseLine( parser, record, message );
+        if( result > 0 ) {
+            records.push_back( record );
+        }
+        else if( result < 0 ) {
+            errors.add( line, message );
+        }
+        line++;
+        begin = lineEnd == end ? end : lineEnd + 1;
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           parseChunk
+//  Description:    parseLines split across threads. The text is cut
+//                  into one piece per thread at line boundaries,
+//                  each piece is parsed on its own, and the results
+//                  are joined back in file order. Small chunks are
+//                  parsed on the calling thread.
+//  Arguments:      As parseLines, plus the number of threads (0 for
+//                  all cores).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Record, class ParseLine>
+void parseChunk( const char* begin, const char* end, long long line, ParseLine const & parseLine, std::vector<Record>& records, LoadErrors& errors, int threads = 0 ) {
+    const int MINPIECE = 1 << 18;
+    if( threads <= 0 ) {
+        threads = hardwareThreads();
+    }
+    int pieces = std::min<int>( threads, (int)( ( end - begin ) / MINPIECE ) );
+    if( pieces <= 1 ) {
+        parseLines( begin, end, line, parseLine, records, errors );
+        return;
+    }
+
+    // piece boundaries, moved forward to the start of a line.
+    std::vector<const char*> bounds( pieces + 1 );
+    std::vector<long long> firstLine( pieces + 1 );
+    bounds[0] = begin;
+    bounds[pieces] = end;
+    for( int t = 1; t < pieces; t++ ) {
+        const char* cut = begin + ( end - begin ) * (long long)t / pieces;
+        cut = std::find( std::max( cut, bounds[t - 1] ), end, '\n' );
+        bounds[t] = cut == end ? end : cut + 1;
+    }
+    firstLine[0] = line;
+    for( int t = 0; t < pieces; t++ ) {
+        firstLine[t + 1] = firstLine[t] + std::count( bounds[t], bounds[t + 1], '\n' );
+    }
+
+    std::vector< std::vector<Record> > pieceRecords( pieces );
+    std::vector<LoadErrors> pieceErrors( pieces );
+    parallelFor( 0, pieces, [&]( int lo, int hi, int ) {
+        for( int t = lo; t < hi; t++ ) {
+            parseLines( bounds[t], bounds[t + 1], firstLine[t], parseLine, pieceRecords[t], pieceErrors[t] );
+        }
+    }, pieces, 1 );
+
+    for( int t = 0; t < pieces; t++ ) {
+        records.insert( records.end(), pieceRecords[t].begin(), pieceRecords[t].end() );
+        errors.append( pieceErrors[t] );
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           parseNodeLine / ArcLineParser
+//  Description:    The line formats of nodes.txt and arcs.txt. Arc
+//                  ends must name one of the loaded nodes, and arc
+//                  weights must not be negative.
+// ----------------------------------------------------------------
+inline int parseNodeLine( LineParser& parser, NodeRecord& node, const char*& message ) {
+    if( parser.atEnd() ) {
+        return 0;
+    }
+    parser.readWord( node.name );
+    if( !parser.readInt( node.x ) || !parser.readInt( node.y ) ) {
+        message = "expected \"name x y\" with whole number coordinates";
+        return -1;
+    }
+    if( !parser.atEnd() ) {
+        message = "unexpected text after the node position";
+        return -1;
+    }
+    return 1;
+}
+
+struct ArcLineParser {
+    int m_nodeCount;
+
+    explicit ArcLineParser( int nodeCount ) : m_nodeCount( nodeCount ) {}
+
+    int operator()( LineParser& parser, ArcRecord& arc, const char*& message ) const {
+        if( parser.atEnd() ) {
+            return 0;
+        }
+        if( !parser.readInt( arc.from ) || !parser.readInt( arc.to ) || !parser.readInt( arc.weight ) ) {
+            message = "expected \"from to weight\" as three whole numbers";
+            return -1;
+        }
+        if( !parser.atEnd() ) {
+            message = "unexpected text after the arc weight";
+            return -1;
+        }
+        if( arc.from < 0 || arc.from >= m_nodeCount || arc.to < 0 || arc.to >= m_nodeCount ) {
+            message = "arc refers to a node that is not in the node file";
+            return -1;
+        }
+        if( arc.weight < 0 ) {
+            message = "arc weight is negative; the searches need weights of zero or more";
+            return -1;
+        }
+        return 1;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           loadNodes
+//  Description:    Reads every node in the file. The number of nodes
+//                  read is the size the graph needs, so callers no
+//                  longer have to know it in advance. A node's id is
+//                  its place among the node lines (blank lines do
+//                  not count), and arcs.txt refers to nodes by that
+//                  id. Dropping a malformed line would move every
+//                  later node down one id and attach their arcs to
+//                  the wrong nodes, so any malformed line fails the
+//                  whole load instead.
+//  Arguments:      The file, where to put the nodes and errors, and
+//                  the number of threads (0 for all cores).
+//  Return Value:   false if the file could not be opened (errors
+//                  unchanged) or has a malformed line (errors holds
+//                  the lines, and nodes is left empty).
+// ----------------------------------------------------------------
+inline bool loadNodes( const char* path, std::vector<NodeRecord>& nodes, LoadErrors& errors, int threads = 0 ) {
+    nodes.clear();
+    long long before = errors.count();
+    bool opened = readChunks( path, [&]( const char* begin, const char* end, long long line ) {
+        parseChunk( begin, end, line, parseNodeLine, nodes, errors, threads );
+    } );
+    if( errors.count() != before ) {
+        nodes.clear();
+        return false;
+    }
+    return opened;
+}
+
+// ----------------------------------------------------------------
+//  Name:           loadArcs
+//  Description:    Streams the arcs in the file to visit( from, to,
+//                  weight ), one block at a time and in file order.
+//                  Blocks are parsed in parallel but visit is only
+//                  ever called from the calling thread, so it can
+//                  add to a Graph directly. The arc list itself is
+//                  never held in memory.
+//  Arguments:      The file, the number of nodes, the function to
+//                  call, where to put errors and the thread count.
+//  Return Value:   false if the file could not be opened.
+// ----------------------------------------------------------------
+template<class Visit>
+bool loadArcs( const char* path, int nodeCount, Visit visit, LoadErrors& errors, int threads = 0 ) {
+    ArcLineParser parseLine( nodeCount );
+    std::vector<ArcRecord> arcs;
+    return readChunks( path, [&]( const char* begin, const char* end, long long line ) {
+        arcs.clear();
+        parseChunk( begin, end, line, parseLine, arcs, errors, threads );
+        for( int i = 0; i < (int)arcs.size(); i++ ) {
+            visit( arcs[i].from, arcs[i].to, arcs[i].weight );
+        }
+    } );
+}
+
+// ----------------------------------------------------------------
+//  Name:           ArcFile
+//  Description:    An arc file as a source for CompactGraph's two
+//                  pass build, which reads the file once to count
+//                  and once to fill. Errors are only recorded on the
+//                  first read.
+// ----------------------------------------------------------------
+class ArcFile {
+private:
+    std::string m_path;
+    int m_nodeCount;
+    int m_threads;
+    int m_reads;
+    LoadErrors& m_errors;
+
+public:
+    ArcFile( std::string const & path, int nodeCount, LoadErrors& errors, int threads = 0 )
+        : m_path( path ), m_nodeCount( nodeCount ), m_threads( threads ), m_reads( 0 ), m_errors( errors ) {}
+
+    template<class Visit>
+    bool operator()( Visit visit ) {
+        LoadErrors ignored;
+        LoadErrors& errors = m_reads++ == 0 ? m_errors : ignored;
+        return loadArcs( m_path.c_str(), m_nodeCount, visit, errors, m_threads );
+    }
+};
+
+#endif
@@ -37,17 +37,20 @@ private:
 // Description: pointer to previous node
 // -------------------------------------------------------
 	Node *m_previous;
-	sf::Vertex line[2];
+
+// -------------------------------------------------------
+// Description: index of the node in the graph's node array
+// -------------------------------------------------------
+	int m_index;
 	sf::Vector2f m_position;
 	sf::CircleShape m_shape;
 	const int m_size = 30;
 	sf::Color m_color;
 	sf::Text m_text;
-	sf::Font font;
 	
 public:
 	// Constructor function
-	GraphNode( Node * previous = 0 ) : m_previous( previous ) {}
+	GraphNode( Node * previous = 0 ) : m_previous( previous ), m_index( -1 ) {}
 
     // Accessor functions
     list<Arc> const & arcList() const {
@@ -66,6 +69,10 @@ public:
 		return m_previous;
 	}
 
+	int index() const {
+		return m_index;
+	}
+
     // Manipulator functions
     void setData(NodeType data) {
         m_data = data;
@@ -79,6 +86,10 @@ public:
 		m_previous = previous;
 	}
 
+	void setIndex(int index) {
+		m_index = index;
+	}
+
 
 
     Arc* getArc( Node* pNode );    
@@ -87,7 +98,8 @@ public:
 
 	int GetSize(){ return m_size; }
 	void SetPosition(sf::Vector2f p_pos){m_position = p_pos; }
-	void SetColor(sf::Color p_color){m_shape.setFillColor(p_color);}
+	void SetColor(sf::Color p_color){m_color = p_color; m_shape.setFillColor(p_color);}
+	sf::Color GetColor(){ return m_color; }
 	void SetText(std::string p_string){ m_text.setString(p_string);}
 	sf::Vector2f getPosition(){ return m_position; }
 
@@ -95,36 +107,35 @@ public:
 	{
 		m_marked = false;
 		m_previous = NULL;
-		m_shape.setFillColor(sf::Color(255, 255, 255));
+		SetColor(sf::Color(255, 255, 255));
 		m_text.setString("    " + (get<0>(m_data)) + "\n" + " C-??? " + "\n" + " H-??? ");
 	}
 
-	void SetUpNode(sf::Font p_font)
+	// The text keeps a pointer to the font, which is shared by every
+	// node and must outlive the graph
+	void SetUpNode(sf::Font const & p_font)
 	{
-		font = p_font;
 		m_shape.setOrigin(m_size, m_size);
 		m_shape.setPosition(m_position);
 		m_shape.setRadius(m_size);
+		SetColor(sf::Color(255, 255, 255));
 		m_text.setPosition(sf::Vector2f(m_position.x - 25, m_position.y - 30));
 		m_text.setString("    " + (get<0>(m_data)) + "\n" + " C-??? " + "\n" + " H-??? ");
 		m_text.setCharacterSize(15);
 		m_text.setColor(sf::Color(0, 0, 0));
-		m_text.setFont(font);
+		m_text.setFont(p_font);
 		m_text.setStyle(sf::Text::Bold);
 	}
 
-	void DrawArcs(sf::RenderWindow &p_window)
-	{
-		list<Arc>::iterator iter = m_arcList.begin();
-		list<Arc>::iterator endIter = m_arcList.end();
-		for (; iter != endIter; ++iter)
-			(*iter).Draw(p_window);
-	}
 	void Draw(sf::RenderWindow &p_window)
 	{
 		p_window.draw(m_shape);
 		p_window.draw(m_text);
 	}
+	void DrawText(sf::RenderTarget &p_window)
+	{
+		p_window.draw(m_text);
+	}
 };
 
 // ----------------------------------------------------------------
@@ -169,12 +180,6 @@ void GraphNode<NodeType, ArcType>::addArc( Node* pNode, ArcType weight ) {
    Arc a;
    a.setNode(pNode);
    a.setWeight(weight);
-   a.setLine(m_shape.getPosition(), pNode->getPosition());
-   /*
-   a.setLines(m_shape.getPos, pNode->getPosition);
-   a.lines[0] = m_SHAPE.GETPOS;
-   a.lines[1] = pNode->getPostion();
-   */
 
    // Add it to the arc list.
    m_arcList.push_back( a );
@@ -190,14 +195,14 @@ void GraphNode<NodeType, ArcType>::addArc( Node* pNode, ArcType weight ) {
 // ----------------------------------------------------------------
 template<typename NodeType, typename ArcType>
 void GraphNode<NodeType, ArcType>::removeArc( Node* pNode ) {
-     list<Arc>::iterator iter = m_arcList.begin();
-     list<Arc>::iterator endIter = m_arcList.end();
+     typename list<Arc>::iterator iter = m_arcList.begin();
+     typename list<Arc>::iterator endIter = m_arcList.end();
 
-     int size = m_arcList.size();
-     // find the arc that matches the node
-     for( ; iter != endIter && m_arcList.size() == size; ++iter ) {
+     // find the arc that matches the node and erase it
+     for( ; iter != endIter; ++iter ) {
           if ( (*iter).node() == pNode) {
-             m_arcList.remove( (*iter) );
+             m_arcList.erase( iter );
+             break;
           }                           
      }
 }
@@ -0,0 +1,246 @@
+#ifndef GRAPHORDERING_H
+#define GRAPHORDERING_H
+
+#include <vector>
+#include <algorithm>
+#include "SFML/System/Vector2.hpp"
+#include "CompactGraph.h"
+#include "GraphLoader.h"
+
+template <class NodeType, class ArcType> class Graph;
+
+// ----------------------------------------------------------------
+//  Name:           NodeOrdering
+//  Description:    A renumbering of a graph's nodes. "External" ids
+//                  are the ones callers use (the Graph's indices,
+//                  the line order of nodes.txt); "internal" ids are
+//                  the positions in a reordered CompactGraph. Keep
+//                  the ordering next to the reordered graph and
+//                  translate at the edges of every query.
+// ----------------------------------------------------------------
+class NodeOrdering {
+private:
+    std::vector<int> m_toInternal;
+    std::vector<int> m_toExternal;
+
+public:
+    NodeOrdering() {}
+
+    // Sets the order from a list of external ids, first one first.
+    explicit NodeOrdering( std::vector<int> const & order ) {
+        setOrder( order );
+    }
+
+    void setOrder( std::vector<int> const & order ) {
+        m_toExternal = order;
+        m_toInternal.assign( order.size(), -1 );
+        for( int i = 0; i < (int)order.size(); i++ ) {
+            m_toInternal[order[i]] = i;
+        }
+    }
+
+    // Accessors
+    int size() const {
+        return (int)m_toExternal.size();
+    }
+
+    int internal( int external ) const {
+        return m_toInternal[external];
+    }
+
+    int external( int internal ) const {
+        return m_toExternal[internal];
+    }
+
+    std::vector<int> const & toInternal() const {
+        return m_toInternal;
+    }
+
+    // Rewrites a list of internal ids (such as a path) as external ids.
+    void toExternal( std::vector<int>& nodes ) const {
+        for( int i = 0; i < (int)nodes.size(); i++ ) {
+            nodes[i] = m_toExternal[nodes[i]];
+        }
+    }
+
+    // Reorders a per-node array indexed by external id into internal order.
+    template<class T>
+    void permute( std::vector<T>& values ) const {
+        std::vector<T> ordered( values.size() );
+        for( int i = 0; i < (int)m_toExternal.size(); i++ ) {
+            ordered[i] = values[m_toExternal[i]];
+        }
+        values.swap( ordered );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           cuthillMcKeeOrder
+//  Description:    Breadth-first renumbering (Cuthill-McKee). Each
+//                  component is started from its lowest-degree node
+//                  and every node's unvisited neighbours are
+//                  numbered in order of increasing degree. Nodes
+//                  that are joined by an arc end up with nearby
+//                  numbers, so an A* expansion reads neighbouring
+//                  entries of the cost arrays instead of scattered
+//                  ones. Arc direction is ignored.
+//  Arguments:      The graph and the ordering to fill in.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void cuthillMcKeeOrder( CompactGraph<ArcType> const & graph, NodeOrdering& ordering ) {
+    int n = graph.size();
+    std::vector<int> order;
+    std::vector<bool> placed( n, false );
+    std::vector< std::pair<int, int> > neighbours;
+    order.reserve( n );
+
+    // components are started from low-degree nodes first.
+    std::vector< std::pair<int, int> > starts;
+    for( int i = 0; i < n; i++ ) {
+        starts.push_back( std::make_pair( graph.degree( i ) + graph.inDegree( i ), i ) );
+    }
+    std::sort( starts.begin(), starts.end() );
+
+    for( int s = 0; s < n; s++ ) {
+        int start = starts[s].second;
+        if( placed[start] ) {
+            continue;
+        }
+        size_t head = order.size();
+        order.push_back( start );
+        placed[start] = true;
+
+        while( head < order.size() ) {
+            int node = order[head++];
+            neighbours.clear();
+            for( int a = graph.begin( node ); a < graph.end( node ); a++ ) {
+                int next = graph.target( a );
+                if( !placed[next] ) {
+                    placed[next] = true;
+                    neighbours.push_back( std::make_pair( graph.degree( next ) + graph.inDegree( next ), next ) );
+                }
+            }
+            for( int a = graph.rbegin( node ); a < graph.rend( node ); a++ ) {
+                int next = graph.source( a );
+                if( !placed[next] ) {
+                    placed[next] = true;
+                    neighbours.push_back( std::make_pair( graph.degree( next ) + graph.inDegree( next ), next ) );
+                }
+            }
+            std::sort( neighbours.begin(), neighbours.end() );
+            for( int i = 0; i < (int)neighbours.size(); i++ ) {
+                order.push_back( neighbours[i].second );
+            }
+        }
+    }
+    ordering.setOrder( order );
+}
+
+// ----------------------------------------------------------------
+//  Name:           hilbertIndex
+//  Description:    Position of a cell along a Hilbert curve over a
+//                  2^16 by 2^16 grid. Cells close on the curve are
+//                  close in space.
+//  Arguments:      The cell coordinates, 0 to 65535.
+//  Return Value:   The distance along the curve.
+// ----------------------------------------------------------------
+inline unsigned long long hilbertIndex( unsigned x, unsigned y ) {
+    unsigned long long d = 0;
+    for( unsigned s = 1u << 15; s > 0; s >>= 1 ) {
+        unsigned rx = ( x & s ) > 0;
+        unsigned ry = ( y & s ) > 0;
+        d += (unsigned long long)s * s * ( ( 3 * rx ) ^ ry );
+        // rotate the quadrant so the curve stays continuous.
+        if( ry == 0 ) {
+            if( rx == 1 ) {
+                x = s - 1 - ( x & ( s - 1 ) );
+                y = s - 1 - ( y & ( s - 1 ) );
+            }
+            unsigned swap = x;
+            x = y;
+            y = swap;
+        }
+    }
+    return d;
+}
+
+// ----------------------------------------------------------------
+//  Name:           hilbertOrderOf
+//  Description:    The work of hilbertOrder for n indices, whatever
+//                  holds the positions: position( i, p ) sets p and
+//                  returns true for the indices that hold a node.
+//  Arguments:      The number of indices, the position function and
+//                  the ordering to fill in.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Position>
+void hilbertOrderOf( int n, Position position, NodeOrdering& ordering ) {
+    // bounding box of the nodes.
+    bool any = false;
+    sf::Vector2f lo, hi, p;
+    for( int i = 0; i < n; i++ ) {
+        if( position( i, p ) ) {
+            if( !any || p.x < lo.x ) lo.x = p.x;
+            if( !any || p.y < lo.y ) lo.y = p.y;
+            if( !any || p.x > hi.x ) hi.x = p.x;
+            if( !any || p.y > hi.y ) hi.y = p.y;
+            any = true;
+        }
+    }
+    float width = hi.x - lo.x > 0.0f ? hi.x - lo.x : 1.0f;
+    float height = hi.y - lo.y > 0.0f ? hi.y - lo.y : 1.0f;
+
+    std::vector< std::pair<unsigned long long, int> > keyed( n );
+    for( int i = 0; i < n; i++ ) {
+        if( position( i, p ) ) {
+            unsigned x = (unsigned)( ( p.x - lo.x ) / width * 65535.0f );
+            unsigned y = (unsigned)( ( p.y - lo.y ) / height * 65535.0f );
+            keyed[i] = std::make_pair( hilbertIndex( x, y ), i );
+        }
+        else {
+            keyed[i] = std::make_pair( ~0ull, i );
+        }
+    }
+    std::sort( keyed.begin(), keyed.end() );
+
+    std::vector<int> order( n );
+    for( int i = 0; i < n; i++ ) {
+        order[i] = keyed[i].second;
+    }
+    ordering.setOrder( order );
+}
+
+// ----------------------------------------------------------------
+//  Name:           hilbertOrder
+//  Description:    Renumbers the nodes along a Hilbert curve through
+//                  their positions, so nodes near each other on the
+//                  map get nearby numbers. Suits navigation graphs
+//                  where arcs join nearby nodes. Empty indices go
+//                  last. The second form takes the positions from
+//                  the node file, for graphs built straight into a
+//                  CompactGraph by the loader.
+//  Arguments:      The graph (or its node records) and the ordering
+//                  to fill in.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void hilbertOrder( Graph<NodeType, ArcType> const & graph, NodeOrdering& ordering ) {
+    GraphNode<NodeType, ArcType>** pNodes = graph.nodeArray();
+    hilbertOrderOf( graph.maxNodes(), [pNodes]( int i, sf::Vector2f& p ) -> bool {
+        if( pNodes[i] == 0 ) {
+            return false;
+        }
+        p = pNodes[i]->getPosition();
+        return true;
+    }, ordering );
+}
+
+inline void hilbertOrder( std::vector<NodeRecord> const & nodes, NodeOrdering& ordering ) {
+    hilbertOrderOf( (int)nodes.size(), [&nodes]( int i, sf::Vector2f& p ) -> bool {
+        p = sf::Vector2f( (float)nodes[i].x, (float)nodes[i].y );
+        return true;
+    }, ordering );
+}
+
+#endif
@@ -0,0 +1,333 @@
+#ifndef GRAPHVIEW_H
+#define GRAPHVIEW_H
+
+#include <vector>
+#include <list>
+#include <map>
+#include <cmath>
+#include <string>
+#include "SFML/Graphics.hpp"
+
+template <class NodeType, class ArcType> class Graph;
+template <class NodeType, class ArcType> class GraphArc;
+template <class NodeType, class ArcType> class GraphNode;
+
+// ----------------------------------------------------------------
+//  Name:           GraphView
+//  Description:    Draws a Graph in a few batched draw calls. The
+//                  graph is cut into square chunks; every chunk
+//                  keeps one vertex array with its arcs (as lines)
+//                  and one with its nodes (as triangle fans), so a
+//                  frame costs two draw calls per visible chunk, not
+//                  several per node and arc. Chunks outside the
+//                  view are skipped. The arrays are only rebuilt
+//                  when the view is told that something changed:
+//                  markDirty() after nodes or arcs are added or
+//                  removed, markColorsDirty() after node colours
+//                  change. Node and weight labels are only drawn
+//                  once the view is zoomed in far enough to read
+//                  them.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class GraphView {
+private:
+    // typedef the classes to make our lives easier.
+    typedef GraphArc<NodeType, ArcType> Arc;
+    typedef GraphNode<NodeType, ArcType> Node;
+
+    enum {
+        CHUNKSIZE = 512,    // width and height of a chunk in world units.
+        SEGMENTS = 12       // triangles per node circle.
+    };
+
+// ----------------------------------------------------------------
+//  Description:    A weight label, drawn half way along its arc.
+// ----------------------------------------------------------------
+    struct Label {
+        sf::Vector2f position;
+        ArcType weight;
+    };
+
+// ----------------------------------------------------------------
+//  Description:    One chunk. lo and hi bound everything drawn in
+//                  it, including arcs that leave the chunk.
+// ----------------------------------------------------------------
+    struct Chunk {
+        sf::Vector2f lo;
+        sf::Vector2f hi;
+        sf::VertexArray arcs;
+        sf::VertexArray nodes;
+        std::vector<int> members;
+        std::vector<Label> labels;
+    };
+
+// ----------------------------------------------------------------
+//  Description:    Where a node's triangles start, so colour
+//                  changes can be written without a rebuild.
+// ----------------------------------------------------------------
+    struct Slot {
+        int chunk;
+        int first;
+    };
+
+    Graph<NodeType, ArcType>& m_graph;
+    std::vector<Chunk> m_chunks;
+    std::vector<Slot> m_slots;
+
+// ----------------------------------------------------------------
+//  Description:    The unit circle the node fans are built from.
+// ----------------------------------------------------------------
+    std::vector<sf::Vector2f> m_circle;
+
+    sf::View m_view;
+
+// ----------------------------------------------------------------
+//  Description:    World units per pixel; 1 when not zoomed.
+// ----------------------------------------------------------------
+    float m_zoom;
+
+    bool m_dirty;
+    bool m_colorsDirty;
+    sf::Text m_label;
+
+    void rebuild();
+    void refreshColors();
+    void grow( Chunk& chunk, sf::Vector2f point, float radius );
+
+public:
+    GraphView( Graph<NodeType, ArcType>& graph, sf::FloatRect area, sf::Font const & font );
+
+    // Accessors
+    sf::View const & view() const {
+        return m_view;
+    }
+
+    float zoomLevel() const {
+        return m_zoom;
+    }
+
+    // Manipulator functions
+    void markDirty() {
+        m_dirty = true;
+    }
+
+    void markColorsDirty() {
+        m_colorsDirty = true;
+    }
+
+    void zoom( float factor, sf::Vector2f around );
+    void pan( sf::Vector2f pixels );
+    void draw( sf::RenderTarget& target );
+};
+
+// ----------------------------------------------------------------
+//  Name:           GraphView
+//  Description:    Constructor. The view starts out showing area.
+//  Arguments:      The graph to draw, the area of the world to show
+//                  and the font for the weight labels.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+GraphView<NodeType, ArcType>::GraphView( Graph<NodeType, ArcType>& graph, sf::FloatRect area, sf::Font const & font )
+    : m_graph( graph ), m_view( area ), m_zoom( 1.0f ), m_dirty( true ), m_colorsDirty( false ) {
+    for( int i = 0; i <= SEGMENTS; i++ ) {
+        float angle = i * 6.28318531f / SEGMENTS;
+        m_circle.push_back( sf::Vector2f( cos( angle ), sin( angle ) ) );
+    }
+
+    m_label.setFont( font );
+    m_label.setStyle( sf::Text::Bold );
+    m_label.setColor( sf::Color( 0, 255, 0 ) );
+    m_label.setCharacterSize( 15 );
+}
+
+// ----------------------------------------------------------------
+//  Name:           zoom
+//  Description:    Zooms the view, keeping the point under the
+//                  mouse in place.
+//  Arguments:      The factor (below 1 zooms in) and the world
+//                  point to zoom around.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::zoom( float factor, sf::Vector2f around ) {
+    sf::Vector2f centre = m_view.getCenter();
+    m_view.setCenter( around + ( centre - around ) * factor );
+    m_view.zoom( factor );
+    m_zoom *= factor;
+}
+
+// ----------------------------------------------------------------
+//  Name:           pan
+//  Description:    Moves the view.
+//  Arguments:      The distance to move, in screen pixels.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::pan( sf::Vector2f pixels ) {
+    m_view.move( pixels * m_zoom );
+}
+
+// ----------------------------------------------------------------
+//  Name:           grow
+//  Description:    Grows a chunk's bounds to cover a point.
+//  Arguments:      The chunk, the point and a margin around it.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::grow( Chunk& chunk, sf::Vector2f point, float radius ) {
+    if( point.x - radius < chunk.lo.x ) chunk.lo.x = point.x - radius;
+    if( point.y - radius < chunk.lo.y ) chunk.lo.y = point.y - radius;
+    if( point.x + radius > chunk.hi.x ) chunk.hi.x = point.x + radius;
+    if( point.y + radius > chunk.hi.y ) chunk.hi.y = point.y + radius;
+}
+
+// ----------------------------------------------------------------
+//  Name:           rebuild
+//  Description:    Puts every node, with its outgoing arcs, into the
+//                  chunk its centre falls in and regenerates the
+//                  vertex arrays.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::rebuild() {
+    std::map< std::pair<int, int>, int > cells;
+    Node** pNodes = m_graph.nodeArray();
+
+    m_chunks.clear();
+    m_slots.assign( m_graph.maxNodes(), Slot() );
+
+    for( int i = 0; i < m_graph.maxNodes(); i++ ) {
+        if( pNodes[i] == 0 ) {
+            m_slots[i].chunk = -1;
+            continue;
+        }
+
+        sf::Vector2f pos = pNodes[i]->getPosition();
+        std::pair<int, int> cell( (int)floor( pos.x / CHUNKSIZE ), (int)floor( pos.y / CHUNKSIZE ) );
+        std::map< std::pair<int, int>, int >::iterator found = cells.find( cell );
+        if( found == cells.end() ) {
+            found = cells.insert( std::make_pair( cell, (int)m_chunks.size() ) ).first;
+            m_chunks.push_back( Chunk() );
+            m_chunks.back().lo = pos;
+            m_chunks.back().hi = pos;
+            m_chunks.back().arcs.setPrimitiveType( sf::Lines );
+            m_chunks.back().nodes.setPrimitiveType( sf::Triangles );
+        }
+        Chunk& chunk = m_chunks[found->second];
+        float radius = (float)pNodes[i]->GetSize();
+
+        // the node, as a fan of triangles around its centre.
+        m_slots[i].chunk = found->second;
+        m_slots[i].first = (int)chunk.nodes.getVertexCount();
+        sf::Color color = pNodes[i]->GetColor();
+        for( int s = 0; s < SEGMENTS; s++ ) {
+            chunk.nodes.append( sf::Vertex( pos, color ) );
+            chunk.nodes.append( sf::Vertex( pos + m_circle[s] * radius, color ) );
+            chunk.nodes.append( sf::Vertex( pos + m_circle[s + 1] * radius, color ) );
+        }
+        chunk.members.push_back( i );
+        grow( chunk, pos, radius );
+
+        // its arcs, and a label half way along each.
+        typename std::list<Arc>::const_iterator iter = pNodes[i]->arcList().begin();
+        typename std::list<Arc>::const_iterator endIter = pNodes[i]->arcList().end();
+        for( ; iter != endIter; ++iter ) {
+            sf::Vector2f end = (*iter).node()->getPosition();
+            chunk.arcs.append( sf::Vertex( pos ) );
+            chunk.arcs.append( sf::Vertex( end ) );
+            grow( chunk, end, 0.0f );
+
+            Label label;
+            label.position = ( ( pos - end ) / 2.0f ) + end - sf::Vector2f( 10, 10 );
+            label.weight = (*iter).weight();
+            chunk.labels.push_back( label );
+        }
+    }
+
+    m_dirty = false;
+    m_colorsDirty = false;
+}
+
+// ----------------------------------------------------------------
+//  Name:           refreshColors
+//  Description:    Rewrites the colour of every node's triangles.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::refreshColors() {
+    Node** pNodes = m_graph.nodeArray();
+    for( int i = 0; i < (int)m_slots.size(); i++ ) {
+        if( m_slots[i].chunk != -1 ) {
+            sf::VertexArray& vertices = m_chunks[m_slots[i].chunk].nodes;
+            sf::Color color = pNodes[i]->GetColor();
+            for( int v = 0; v < SEGMENTS * 3; v++ ) {
+                vertices[m_slots[i].first + v].color = color;
+            }
+        }
+    }
+    m_colorsDirty = false;
+}
+
+// ----------------------------------------------------------------
+//  Name:           draw
+//  Description:    Brings the vertex arrays up to date if needed and
+//                  draws the chunks that overlap the view, arcs
+//                  first so the nodes cover their ends. Restores the
+//                  target's view afterwards.
+//  Arguments:      The target to draw to.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::draw( sf::RenderTarget& target ) {
+    // labels are unreadable once a pixel covers more than this.
+    const float LABELZOOM = 1.5f;
+
+    if( m_dirty ) {
+        rebuild();
+    }
+    else if( m_colorsDirty ) {
+        refreshColors();
+    }
+
+    sf::View previous = target.getView();
+    target.setView( m_view );
+
+    sf::Vector2f lo = m_view.getCenter() - m_view.getSize() / 2.0f;
+    sf::Vector2f hi = m_view.getCenter() + m_view.getSize() / 2.0f;
+    std::vector<int> visible;
+    for( int c = 0; c < (int)m_chunks.size(); c++ ) {
+        Chunk const & chunk = m_chunks[c];
+        if( chunk.hi.x >= lo.x && chunk.lo.x <= hi.x && chunk.hi.y >= lo.y && chunk.lo.y <= hi.y ) {
+            visible.push_back( c );
+        }
+    }
+
+    for( int i = 0; i < (int)visible.size(); i++ ) {
+        target.draw( m_chunks[visible[i]].arcs );
+    }
+    for( int i = 0; i < (int)visible.size(); i++ ) {
+        target.draw( m_chunks[visible[i]].nodes );
+    }
+
+    if( m_zoom <= LABELZOOM ) {
+        Node** pNodes = m_graph.nodeArray();
+        for( int i = 0; i < (int)visible.size(); i++ ) {
+            Chunk const & chunk = m_chunks[visible[i]];
+            for( int n = 0; n < (int)chunk.members.size(); n++ ) {
+                pNodes[chunk.members[n]]->DrawText( target );
+            }
+            for( int l = 0; l < (int)chunk.labels.size(); l++ ) {
+                m_label.setPosition( chunk.labels[l].position );
+                m_label.setString( std::to_string( chunk.labels[l].weight ) );
+                target.draw( m_label );
+            }
+        }
+    }
+
+    target.setView( previous );
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef PACKEDGRAPH_H
+#define PACKEDGRAPH_H
+
+#include <vector>
+#include "CompactGraph.h"
+
+// ----------------------------------------------------------------
+//  Name:           PackedGraph
+//  Description:    The smallest layout: a CompactGraph's forward
+//                  arcs only, with each arc's target and weight
+//                  side by side in one array. That is 4 bytes of
+//                  offset (and a bit) per node and 8 bytes per arc
+//                  for int or float weights, against 16 per arc for
+//                  a CompactGraph and well over 100 for a Graph.
+//                  Scanning a node's arcs reads one run of memory
+//                  instead of two.
+//
+//                  There are no reverse arcs, so only forward
+//                  searches can run on it: AStarSearch run() with
+//                  GraphType PackedGraph, but not runFromGoals, and
+//                  not FlowField or Theta*.
+// ----------------------------------------------------------------
+template<class ArcType>
+class PackedGraph {
+private:
+    struct PackedArc {
+        int target;
+        ArcType weight;
+    };
+
+// ----------------------------------------------------------------
+//  Description:    First arc of each node, plus one past the end.
+// ----------------------------------------------------------------
+    std::vector<int> m_offsets;
+
+// ----------------------------------------------------------------
+//  Description:    Every arc, grouped by the node it leaves.
+// ----------------------------------------------------------------
+    std::vector<PackedArc> m_arcs;
+
+// ----------------------------------------------------------------
+//  Description:    true for every index that holds a node.
+// ----------------------------------------------------------------
+    std::vector<bool> m_present;
+
+public:
+    PackedGraph() {}
+
+    explicit PackedGraph( CompactGraph<ArcType> const & graph ) {
+        build( graph );
+    }
+
+    void build( CompactGraph<ArcType> const & graph );
+
+    // Accessors
+    int size() const {
+        return (int)m_present.size();
+    }
+
+    int arcCount() const {
+        return (int)m_arcs.size();
+    }
+
+    bool present( int node ) const {
+        return m_present[node];
+    }
+
+    int begin( int node ) const {
+        return m_offsets[node];
+    }
+
+    int end( int node ) const {
+        return m_offsets[node + 1];
+    }
+
+    int target( int arc ) const {
+        return m_arcs[arc].target;
+    }
+
+    ArcType weight( int arc ) const {
+        return m_arcs[arc].weight;
+    }
+
+    int degree( int node ) const {
+        return m_offsets[node + 1] - m_offsets[node];
+    }
+
+    // Bytes held by the arrays that grow with the nodes and the arcs.
+    size_t nodeBytes() const {
+        return m_offsets.capacity() * sizeof( int ) + m_present.capacity() / 8;
+    }
+
+    size_t arcBytes() const {
+        return m_arcs.capacity() * sizeof( PackedArc );
+    }
+
+    size_t slackBytes() const {
+        return ( m_offsets.capacity() - m_offsets.size() ) * sizeof( int )
+             + ( m_arcs.capacity() - m_arcs.size() ) * sizeof( PackedArc );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Copies the forward arcs out of a CompactGraph.
+//                  Each array is allocated once at its final size.
+//  Arguments:      The graph to copy.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void PackedGraph<ArcType>::build( CompactGraph<ArcType> const & graph ) {
+    int n = graph.size();
+    std::vector<int>( n + 1 ).swap( m_offsets );
+    std::vector<PackedArc>( graph.arcCount() ).swap( m_arcs );
+    std::vector<bool>( n ).swap( m_present );
+
+    for( int i = 0; i < n; i++ ) {
+        m_present[i] = graph.present( i );
+        m_offsets[i] = graph.begin( i );
+        for( int a = graph.begin( i ); a < graph.end( i ); a++ ) {
+            m_arcs[a].target = graph.target( a );
+            m_arcs[a].weight = graph.weight( a );
+        }
+    }
+    m_offsets[n] = graph.arcCount();
+}
+
+#endif
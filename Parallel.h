@@ -0,0 +1,111 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <vector>
+#include <atomic>
+#include <thread>
+
+// ----------------------------------------------------------------
+//  Name:           hardwareThreads
+//  Description:    The number of threads worth running at once.
+//  Arguments:      None.
+//  Return Value:   At least 1.
+// ----------------------------------------------------------------
+inline int hardwareThreads() {
+    int threads = (int)std::thread::hardware_concurrency();
+    return threads > 0 ? threads : 1;
+}
+
+// ----------------------------------------------------------------
+//  Name:           parallelFor
+//  Description:    Splits [begin, end) into one contiguous chunk per
+//                  thread and calls process( lo, hi, thread ) for
+//                  each chunk. Ranges smaller than minChunk per
+//                  thread run on the calling thread only, so small
+//                  loops do not pay for starting threads.
+//  Arguments:      The range, the processing function, the number
+//                  of threads (0 for all cores) and the minimum
+//                  chunk size.
+//  Return Value:   None. Returns once every chunk has finished.
+// ----------------------------------------------------------------
+template<class Process>
+void parallelFor( int begin, int end, Process process, int threads = 0, int minChunk = 4096 ) {
+    if( threads <= 0 ) {
+        threads = hardwareThreads();
+    }
+    int count = end - begin;
+    if( count <= 0 ) {
+        return;
+    }
+    if( threads > count / minChunk ) {
+        threads = count / minChunk;
+    }
+    if( threads <= 1 ) {
+        process( begin, end, 0 );
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    int chunk = ( count + threads - 1 ) / threads;
+    // the calling thread takes the first chunk itself.
+    for( int t = 1; t < threads; t++ ) {
+        int lo = begin + t * chunk;
+        int hi = lo + chunk < end ? lo + chunk : end;
+        if( lo < hi ) {
+            workers.push_back( std::thread( process, lo, hi, t ) );
+        }
+    }
+    process( begin, begin + chunk < end ? begin + chunk : end, 0 );
+
+    for( int t = 0; t < (int)workers.size(); t++ ) {
+        workers[t].join();
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           AtomicBitmap
+//  Description:    One bit per node that any number of threads can
+//                  set at once. testAndSet tells the caller whether
+//                  it was the thread that set the bit.
+// ----------------------------------------------------------------
+class AtomicBitmap {
+private:
+    std::vector< std::atomic<unsigned> > m_words;
+
+public:
+    AtomicBitmap() {}
+
+    explicit AtomicBitmap( int size ) {
+        reset( size );
+    }
+
+    // Clears every bit, resizing to hold size bits.
+    void reset( int size ) {
+        int words = ( size + 31 ) / 32;
+        if( (int)m_words.size() != words ) {
+            std::vector< std::atomic<unsigned> >( words ).swap( m_words );
+        }
+        for( int i = 0; i < words; i++ ) {
+            m_words[i].store( 0, std::memory_order_relaxed );
+        }
+    }
+
+    bool test( int bit ) const {
+        return ( m_words[bit >> 5].load( std::memory_order_relaxed ) & ( 1u << ( bit & 31 ) ) ) != 0;
+    }
+
+    void set( int bit ) {
+        m_words[bit >> 5].fetch_or( 1u << ( bit & 31 ), std::memory_order_relaxed );
+    }
+
+    // true if this call set the bit, false if it was already set.
+    bool testAndSet( int bit ) {
+        unsigned mask = 1u << ( bit & 31 );
+        if( m_words[bit >> 5].load( std::memory_order_relaxed ) & mask ) {
+            return false;
+        }
+        return ( m_words[bit >> 5].fetch_or( mask, std::memory_order_relaxed ) & mask ) == 0;
+    }
+};
+
+#endif
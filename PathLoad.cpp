@@ -0,0 +1,211 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#ifdef _DEBUG
+#pragma comment(lib,"sfml-system-d.lib")
+#pragma comment(lib,"sfml-network-d.lib")
+#else
+#pragma comment(lib,"sfml-system.lib")
+#pragma comment(lib,"sfml-network.lib")
+#endif
+
+#include "SFML/Network.hpp"
+
+//standard c++ includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include "GraphLoader.h"
+#include "PathProtocol.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+using namespace std;
+
+// Microseconds from a fixed point. steady_clock in VS2013 only ticks with
+// the system clock, so Windows builds read the performance counter instead
+////////////////////////////
+long long NowMicros() {
+#ifdef _WIN32
+	LARGE_INTEGER frequency, now;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&now);
+	return now.QuadPart / frequency.QuadPart * 1000000 + now.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart;
+#else
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// What one connection saw
+////////////////////////////
+struct ConnectionResult {
+	long long found;
+	long long none;
+	long long bad;
+	bool failed;
+	std::vector<long long> latencies;
+
+	ConnectionResult() : found(0), none(0), bad(0), failed(false) {}
+};
+
+// Sends random requests over one connection, keeping up to depth of them
+// in flight, and times each one from sending to its response arriving
+////////////////////////////
+void RunConnection(string host, unsigned short port, int nodeCount, long long requests, int depth, unsigned seed, ConnectionResult & result) {
+	sf::TcpSocket socket;
+	if (socket.connect(sf::IpAddress(host), port) != sf::Socket::Done) {
+		result.failed = true;
+		return;
+	}
+
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<int> pick(0, nodeCount - 1);
+	std::vector<long long> sentAt((size_t)requests);
+	std::vector<char> out;
+	std::vector<char> buffer(1 << 16);
+	MessageBuffer incoming;
+	PathResponse response;
+	long long sent = 0;
+	long long done = 0;
+	result.latencies.reserve((size_t)requests);
+
+	while (done < requests)
+	{
+		// top up the requests in flight, sent together
+		out.clear();
+		long long now = NowMicros();
+		while (sent < requests && sent - done < depth)
+		{
+			PathRequest request = { (unsigned)sent, pick(random), pick(random) };
+			encodeRequest(out, request);
+			sentAt[(size_t)sent++] = now;
+		}
+		if (!out.empty() && socket.send(&out[0], out.size()) != sf::Socket::Done) {
+			result.failed = true;
+			return;
+		}
+
+		size_t received = 0;
+		if (socket.receive(&buffer[0], buffer.size(), received) != sf::Socket::Done) {
+			result.failed = true;
+			return;
+		}
+		incoming.append(&buffer[0], received);
+		now = NowMicros();
+		while (incoming.nextResponse(response))
+		{
+			result.latencies.push_back(now - sentAt[response.id]);
+			if (response.status == PATH_FOUND)
+				result.found++;
+			else if (response.status == PATH_NONE)
+				result.none++;
+			else
+				result.bad++;
+			done++;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+/// Entry point of application
+//
+// PathLoad [--host address] [--port n] [--connections n] [--depth n]
+//          [--requests n] [--nodes file]
+//
+// Load generator for PathServer. Each connection runs on its own thread
+// and pipelines up to depth requests between random nodes of the graph
+// in the node file; the total requests are split between connections.
+// Reports throughput and latency percentiles.
+////////////////////////////////////////////////////////////
+int main(int argc, char *argv[])
+{
+	string host = "127.0.0.1";
+	unsigned short port = DEFAULT_PATH_PORT;
+	int connections = 4;
+	int depth = 32;
+	long long requests = 100000;
+	string nodesFile = "nodes.txt";
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		string option = argv[i];
+		if (option == "--host")
+			host = argv[i + 1];
+		else if (option == "--port")
+			port = (unsigned short)atoi(argv[i + 1]);
+		else if (option == "--connections")
+			connections = atoi(argv[i + 1]);
+		else if (option == "--depth")
+			depth = atoi(argv[i + 1]);
+		else if (option == "--requests")
+			requests = atoll(argv[i + 1]);
+		else if (option == "--nodes")
+			nodesFile = argv[i + 1];
+		else {
+			cout << "Unknown option " << option << endl;
+			return 1;
+		}
+	}
+	if (connections < 1 || depth < 1 || requests < connections) {
+		cout << "Need at least one connection, a depth of one and a request per connection" << endl;
+		return 1;
+	}
+
+	// Requests go between nodes the server has
+	std::vector<NodeRecord> nodes;
+	LoadErrors loadErrors;
+	if (!loadNodes(nodesFile.c_str(), nodes, loadErrors) || nodes.empty()) {
+		cout << "Could not read any nodes from " << nodesFile << endl;
+		loadErrors.print(cout);
+		return 1;
+	}
+
+	std::vector<ConnectionResult> results(connections);
+	std::vector<std::thread> clients;
+	long long start = NowMicros();
+	for (int i = 0; i < connections; i++)
+	{
+		long long share = requests / connections + (i < requests % connections ? 1 : 0);
+		clients.push_back(std::thread(RunConnection, host, port, (int)nodes.size(), share, depth, 1234u + i, std::ref(results[i])));
+	}
+	for (int i = 0; i < connections; i++)
+		clients[i].join();
+	double seconds = (NowMicros() - start) / 1000000.0;
+
+	// Gather the results
+	///////////////////////////
+	std::vector<long long> latencies;
+	long long found = 0, none = 0, bad = 0;
+	int failed = 0;
+	for (int i = 0; i < connections; i++)
+	{
+		latencies.insert(latencies.end(), results[i].latencies.begin(), results[i].latencies.end());
+		found += results[i].found;
+		none += results[i].none;
+		bad += results[i].bad;
+		failed += results[i].failed ? 1 : 0;
+	}
+	if (failed > 0)
+		cout << failed << " connections failed" << endl;
+	if (latencies.empty())
+		return 1;
+	std::sort(latencies.begin(), latencies.end());
+
+	cout << latencies.size() << " requests in " << seconds << " s: " << (long long)(latencies.size() / seconds) << " requests/s" << endl;
+	cout << "found " << found << ", no path " << none << ", bad " << bad << endl;
+	const double percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+	for (int i = 0; i < 4; i++)
+		cout << "p" << percentiles[i] << " " << latencies[(size_t)((latencies.size() - 1) * percentiles[i] / 100.0)] << " us" << endl;
+	cout << "max " << latencies.back() << " us" << endl;
+
+	return failed > 0 ? 1 : EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+#ifndef PATHPROTOCOL_H
+#define PATHPROTOCOL_H
+
+#include <vector>
+#include <cstring>
+
+// ----------------------------------------------------------------
+//  The wire format between PathServer and its clients. Every field
+//  is a 32 bit little-endian integer.
+//
+//  Request  (12 bytes):  id, start node, goal node
+//  Response (16 bytes + 4 per node):
+//                        id, status, cost, node count, nodes...
+//
+//  A client may send any number of requests without waiting for
+//  answers. Responses come back as they are finished, which need
+//  not be the order they were asked in; the id (chosen by the
+//  client) says which request a response answers.
+// ----------------------------------------------------------------
+enum PathStatus { PATH_FOUND = 0, PATH_NONE = 1, PATH_BAD_REQUEST = 2 };
+
+enum { REQUEST_BYTES = 12, RESPONSE_HEADER_BYTES = 16, DEFAULT_PATH_PORT = 5555 };
+
+struct PathRequest {
+    unsigned id;
+    int start;
+    int goal;
+};
+
+struct PathResponse {
+    unsigned id;
+    int status;
+    int cost;
+    std::vector<int> path;
+};
+
+inline void putU32( std::vector<char>& out, unsigned value ) {
+    out.push_back( (char)( value & 0xff ) );
+    out.push_back( (char)( ( value >> 8 ) & 0xff ) );
+    out.push_back( (char)( ( value >> 16 ) & 0xff ) );
+    out.push_back( (char)( ( value >> 24 ) & 0xff ) );
+}
+
+inline unsigned getU32( const char* p ) {
+    const unsigned char* b = (const unsigned char*)p;
+    return b[0] | ( b[1] << 8 ) | ( b[2] << 16 ) | ( (unsigned)b[3] << 24 );
+}
+
+inline void encodeRequest( std::vector<char>& out, PathRequest const & request ) {
+    putU32( out, request.id );
+    putU32( out, (unsigned)request.start );
+    putU32( out, (unsigned)request.goal );
+}
+
+inline PathRequest decodeRequest( const char* p ) {
+    PathRequest request;
+    request.id = getU32( p );
+    request.start = (int)getU32( p + 4 );
+    request.goal = (int)getU32( p + 8 );
+    return request;
+}
+
+inline void encodeResponse( std::vector<char>& out, unsigned id, int status, int cost, std::vector<int> const & path ) {
+    putU32( out, id );
+    putU32( out, (unsigned)status );
+    putU32( out, (unsigned)cost );
+    putU32( out, (unsigned)path.size() );
+    for( int i = 0; i < (int)path.size(); i++ ) {
+        putU32( out, (unsigned)path[i] );
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           MessageBuffer
+//  Description:    Collects bytes as they arrive from a socket and
+//                  hands back whole messages, keeping any partial
+//                  one for the next read.
+// ----------------------------------------------------------------
+class MessageBuffer {
+private:
+    std::vector<char> m_bytes;
+    size_t m_read;
+
+    void compact() {
+        if( m_read > 0 && m_read * 2 >= m_bytes.size() ) {
+            m_bytes.erase( m_bytes.begin(), m_bytes.begin() + m_read );
+            m_read = 0;
+        }
+    }
+
+public:
+    MessageBuffer() : m_read( 0 ) {}
+
+    void append( const char* data, size_t size ) {
+        m_bytes.insert( m_bytes.end(), data, data + size );
+    }
+
+    size_t available() const {
+        return m_bytes.size() - m_read;
+    }
+
+    bool nextRequest( PathRequest& request ) {
+        if( available() < REQUEST_BYTES ) {
+            compact();
+            return false;
+        }
+        request = decodeRequest( &m_bytes[m_read] );
+        m_read += REQUEST_BYTES;
+        return true;
+    }
+
+    bool nextResponse( PathResponse& response ) {
+        if( available() < RESPONSE_HEADER_BYTES ) {
+            compact();
+            return false;
+        }
+        const char* p = &m_bytes[m_read];
+        unsigned count = getU32( p + 12 );
+        if( available() < RESPONSE_HEADER_BYTES + (size_t)count * 4 ) {
+            compact();
+            return false;
+        }
+        response.id = getU32( p );
+        response.status = (int)getU32( p + 4 );
+        response.cost = (int)getU32( p + 8 );
+        response.path.resize( count );
+        for( unsigned i = 0; i < count; i++ ) {
+            response.path[i] = (int)getU32( p + RESPONSE_HEADER_BYTES + i * 4 );
+        }
+        m_read += RESPONSE_HEADER_BYTES + (size_t)count * 4;
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+
+//standard c++ includes
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+#include "GraphLoader.h"
+#include "CompactGraph.h"
+#include "AStarSearch.h"
+#include "SearchTrace.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////
+/// Entry point of application
+//
+// PathReplay --trace file [--nodes file] [--arcs file] [--show n]
+//
+// Runs every query in a trace file written by PathServer --trace again,
+// on the graph loaded from the node and arc files, and compares the
+// replay with the recording expansion by expansion. Each query that
+// does not match is listed with its first difference. --show n prints
+// the recorded expansions of query n.
+////////////////////////////////////////////////////////////
+int main(int argc, char *argv[])
+{
+	string nodesFile = "nodes.txt";
+	string arcsFile = "arcs.txt";
+	string traceFile;
+	long long show = -1;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		string option = argv[i];
+		if (option == "--nodes")
+			nodesFile = argv[i + 1];
+		else if (option == "--arcs")
+			arcsFile = argv[i + 1];
+		else if (option == "--trace")
+			traceFile = argv[i + 1];
+		else if (option == "--show")
+			show = atoll(argv[i + 1]);
+		else {
+			cout << "Unknown option " << option << endl;
+			return 1;
+		}
+	}
+	if (traceFile.empty()) {
+		cout << "Usage: PathReplay --trace file [--nodes file] [--arcs file] [--show n]" << endl;
+		return 1;
+	}
+
+	// Load the graph the same way the server does
+	///////////////////////////
+	std::vector<NodeRecord> nodes;
+	LoadErrors loadErrors;
+	if (!loadNodes(nodesFile.c_str(), nodes, loadErrors)) {
+		if (loadErrors.count() == 0)
+			cout << "Could not open " << nodesFile << endl;
+		loadErrors.print(cout);
+		return 1;
+	}
+	CompactGraph<int> graph;
+	ArcFile arcs(arcsFile, (int)nodes.size(), loadErrors);
+	if (!graph.build((int)nodes.size(), arcs)) {
+		cout << "Could not read " << arcsFile << endl;
+		return 1;
+	}
+	unsigned long long graphHash = graphFingerprint(graph);
+
+	ifstream file(traceFile.c_str(), ios::in | ios::binary);
+	if (!file) {
+		cout << "Could not open " << traceFile << endl;
+		return 1;
+	}
+
+	// Replay each trace
+	///////////////////////////
+	SearchTrace recorded, replayed;
+	std::unique_ptr<AStarSearch<int> > search;
+	std::vector<int> path;
+	int total = 0;
+	int differ = 0;
+	size_t bytes = 0;
+	while (recorded.read(file))
+	{
+		total++;
+		bytes += recorded.bytes();
+		if (!search || search->scale() != recorded.costScale)
+			search.reset(new AStarSearch<int>(graph, recorded.costScale));
+
+		if (recorded.start < 0 || recorded.start >= graph.size() || recorded.goal < 0 || recorded.goal >= graph.size()) {
+			cout << "query " << recorded.queryId << ": nodes are not in this graph" << endl;
+			differ++;
+			continue;
+		}
+		replayed.queryId = recorded.queryId;
+		replayed.graphVersion = recorded.graphVersion;
+		tracedRun(*search, graphHash, recorded.start, recorded.goal, RecordDistance(nodes, recorded.goal, recorded.heuristicScale),
+			recorded.heuristicScale, path, replayed);
+
+		string diff = diffTraces(recorded, replayed);
+		if (!diff.empty()) {
+			cout << "query " << recorded.queryId << " (" << recorded.start << " to " << recorded.goal << "): " << diff << endl;
+			differ++;
+		}
+
+		if ((long long)recorded.queryId == show) {
+			std::vector<int> expandedNodes;
+			std::vector<long long> costs;
+			recorded.events(expandedNodes, costs);
+			for (int i = 0; i < (int)expandedNodes.size(); i++)
+				cout << i << ": node " << expandedNodes[i] << " cost " << costs[i] << endl;
+		}
+	}
+
+	cout << total << " traces (" << bytes << " bytes of expansions), " << total - differ << " replayed the same, " << differ << " differ" << endl;
+	return differ > 0 ? 1 : EXIT_SUCCESS;
+}
@@ -0,0 +1,363 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#ifdef _DEBUG
+#pragma comment(lib,"sfml-system-d.lib")
+#pragma comment(lib,"sfml-network-d.lib")
+#else
+#pragma comment(lib,"sfml-system.lib")
+#pragma comment(lib,"sfml-network.lib")
+#endif
+
+#include "SFML/Network.hpp"
+
+//standard c++ includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <cstdlib>
+#include "GraphLoader.h"
+#include "CompactGraph.h"
+#include "AStarSearch.h"
+#include "PathProtocol.h"
+#include "SearchTrace.h"
+#include "Footprint.h"
+
+using namespace std;
+
+// Largest number of requests handed to a worker at once
+const int BATCHSIZE = 64;
+
+// Most bytes of results a client may leave unread before it is dropped
+const size_t MAXBACKLOG = 16 << 20;
+
+// How often the network thread retries results a socket would not take
+const int RETRYMS = 5;
+
+// A client, shared between the network thread (which reads from it)
+// and the workers (which write results to it). The socket never blocks:
+// results it will not take yet wait in outgoing, under sendLock
+////////////////////////////
+struct Connection {
+	sf::TcpSocket socket;
+	MessageBuffer incoming;
+	std::mutex sendLock;
+	std::vector<char> outgoing;
+	std::atomic<bool> backlogged;
+	std::atomic<bool> open;
+
+	Connection() : backlogged(false), open(true) {}
+};
+
+// Sends as much of a connection's waiting results as its socket takes
+// without blocking and keeps the rest. A connection that fails, or whose
+// client lets MAXBACKLOG bytes pile up, is marked closed. Call with the
+// connection's sendLock held
+////////////////////////////
+void Flush(Connection & connection) {
+	size_t sent = 0;
+	sf::Socket::Status status = sf::Socket::Done;
+	if (!connection.outgoing.empty())
+		status = connection.socket.send(&connection.outgoing[0], connection.outgoing.size(), sent);
+	connection.outgoing.erase(connection.outgoing.begin(), connection.outgoing.begin() + sent);
+	if ((status != sf::Socket::Done && status != sf::Socket::Partial && status != sf::Socket::NotReady)
+		|| connection.outgoing.size() > MAXBACKLOG) {
+		connection.open = false;
+		std::vector<char>().swap(connection.outgoing);
+	}
+	connection.backlogged = !connection.outgoing.empty();
+}
+
+// Requests from one connection for one worker to answer
+////////////////////////////
+struct Batch {
+	std::shared_ptr<Connection> connection;
+	std::vector<PathRequest> requests;
+};
+
+// The batches waiting for a worker
+////////////////////////////
+class BatchQueue {
+private:
+	std::mutex m_lock;
+	std::condition_variable m_ready;
+	std::deque<Batch> m_batches;
+
+public:
+	void push(Batch & batch) {
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_batches.push_back(Batch());
+			m_batches.back().connection.swap(batch.connection);
+			m_batches.back().requests.swap(batch.requests);
+		}
+		m_ready.notify_one();
+	}
+
+	void pop(Batch & batch) {
+		std::unique_lock<std::mutex> lock(m_lock);
+		while (m_batches.empty())
+			m_ready.wait(lock);
+		batch.connection.swap(m_batches.front().connection);
+		batch.requests.swap(m_batches.front().requests);
+		m_batches.pop_front();
+	}
+};
+
+// Sampled queries are traced to a file for PathReplay
+////////////////////////////
+struct TraceLog {
+	TraceSampler sampler;
+	unsigned long long graphHash;
+	std::atomic<unsigned> queries;
+	std::mutex fileLock;
+	std::ofstream file;
+
+	TraceLog() : graphHash(0), queries(0) {}
+};
+
+// Answers batches until the server stops. Each worker has its own search,
+// so the graph is only ever read and needs no locking
+////////////////////////////
+void Worker(CompactGraph<int> const & graph, std::vector<NodeRecord> const & nodes, double heuristicScale, BatchQueue & queue, TraceLog & traceLog) {
+	AStarSearch<int> search(graph);
+	std::vector<int> path;
+	std::vector<char> out;
+	Batch batch;
+	SearchTrace trace;
+
+	while (true) {
+		queue.pop(batch);
+		if (!batch.connection->open)
+			continue;
+
+		out.clear();
+		for (int i = 0; i < (int)batch.requests.size(); i++)
+		{
+			PathRequest const & request = batch.requests[i];
+			path.clear();
+			if (request.start < 0 || request.start >= graph.size() || request.goal < 0 || request.goal >= graph.size()) {
+				encodeResponse(out, request.id, PATH_BAD_REQUEST, 0, path);
+				continue;
+			}
+			RecordDistance heuristic(nodes, request.goal, heuristicScale);
+			unsigned query = traceLog.queries++;
+			bool found;
+			if (traceLog.sampler.sample(query)) {
+				trace.queryId = query;
+				found = tracedRun(search, traceLog.graphHash, request.start, request.goal, heuristic, heuristicScale, path, trace);
+				std::lock_guard<std::mutex> lock(traceLog.fileLock);
+				trace.write(traceLog.file);
+				traceLog.file.flush();
+			}
+			else
+				found = search.run(request.start, request.goal, heuristic, path);
+			encodeResponse(out, request.id, found ? PATH_FOUND : PATH_NONE, found ? search.cost(request.goal) : 0, path);
+		}
+
+		// one worker writes to a connection at a time so responses never interleave;
+		// whatever the socket will not take now is left for the network thread
+		Connection & connection = *batch.connection;
+		std::lock_guard<std::mutex> lock(connection.sendLock);
+		if (connection.open) {
+			connection.outgoing.insert(connection.outgoing.end(), out.begin(), out.end());
+			Flush(connection);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+/// Entry point of application
+//
+// PathServer [--port n] [--bind address] [--threads n] [--nodes file] [--arcs file]
+//            [--heuristic scale] [--trace file] [--trace-every n]
+//
+// Loads a graph and answers path requests from local clients over TCP
+// (see PathProtocol.h). It only listens on the loopback address unless
+// --bind names another address of this machine, or "any" for all of
+// them; the protocol has no authentication, so only open it up on a
+// trusted network. One thread reads requests from every connection
+// and hands them out in batches; the workers search and send the results
+// straight back without ever blocking on a socket. Results a client is
+// slow to read wait on its connection and the network thread retries
+// them; a client that leaves 16 MB unread is dropped. --heuristic scales the straight line distance between
+// node positions; use 0 if arc weights can be shorter than it. With
+// --trace, about one query in every n is recorded (expansion order and
+// all) so PathReplay can run it again offline and compare.
+////////////////////////////////////////////////////////////
+int main(int argc, char *argv[])
+{
+	unsigned short port = DEFAULT_PATH_PORT;
+	string bindAddress = "127.0.0.1";
+	int threads = hardwareThreads();
+	string nodesFile = "nodes.txt";
+	string arcsFile = "arcs.txt";
+	double heuristicScale = 1.0;
+	string traceFile;
+	unsigned traceEvery = 1000;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		string option = argv[i];
+		if (option == "--port")
+			port = (unsigned short)atoi(argv[i + 1]);
+		else if (option == "--bind")
+			bindAddress = argv[i + 1];
+		else if (option == "--threads")
+			threads = atoi(argv[i + 1]);
+		else if (option == "--nodes")
+			nodesFile = argv[i + 1];
+		else if (option == "--arcs")
+			arcsFile = argv[i + 1];
+		else if (option == "--heuristic")
+			heuristicScale = atof(argv[i + 1]);
+		else if (option == "--trace")
+			traceFile = argv[i + 1];
+		else if (option == "--trace-every")
+			traceEvery = (unsigned)atoi(argv[i + 1]);
+		else {
+			cout << "Unknown option " << option << endl;
+			return 1;
+		}
+	}
+
+	// Load the graph straight into arrays
+	///////////////////////////
+	std::vector<NodeRecord> nodes;
+	LoadErrors loadErrors;
+	if (!loadNodes(nodesFile.c_str(), nodes, loadErrors)) {
+		if (loadErrors.count() == 0)
+			cout << "Could not open " << nodesFile << endl;
+		loadErrors.print(cout);
+		return 1;
+	}
+	CompactGraph<int> graph;
+	ArcFile arcs(arcsFile, (int)nodes.size(), loadErrors);
+	if (!graph.build((int)nodes.size(), arcs)) {
+		cout << "Could not read " << arcsFile << endl;
+		return 1;
+	}
+	loadErrors.print(cout);
+
+	// Open the trace file, traces are added to the end
+	///////////////////////////
+	TraceLog traceLog;
+	if (!traceFile.empty()) {
+		traceLog.file.open(traceFile.c_str(), ios::out | ios::binary | ios::app);
+		if (!traceLog.file) {
+			cout << "Could not open " << traceFile << endl;
+			return 1;
+		}
+		traceLog.sampler = TraceSampler(traceEvery);
+		traceLog.graphHash = graphFingerprint(graph);
+	}
+
+	// Start the workers
+	///////////////////////////
+	BatchQueue queue;
+	for (int i = 0; i < (threads > 0 ? threads : 1); i++)
+		std::thread(Worker, std::cref(graph), std::cref(nodes), heuristicScale, std::ref(queue), std::ref(traceLog)).detach();
+
+	sf::IpAddress address = bindAddress == "any" ? sf::IpAddress::Any : sf::IpAddress(bindAddress);
+	if (address == sf::IpAddress::None) {
+		cout << "Unknown address " << bindAddress << endl;
+		return 1;
+	}
+	sf::TcpListener listener;
+	if (listener.listen(port, address) != sf::Socket::Done) {
+		cout << "Could not listen on " << address.toString() << " port " << port << endl;
+		return 1;
+	}
+	cout << "Serving " << graph.size() << " nodes and " << graph.arcCount() << " arcs on " << address.toString() << " port " << port << " with " << threads << " workers" << endl;
+	MemoryFootprint memory = footprint(graph);
+	// every worker has its own search
+	memory.scratchBytes *= threads > 0 ? threads : 1;
+	printFootprintHeader(cout);
+	printFootprint(cout, memory);
+
+	// Read requests from every connection
+	///////////////////////////
+	sf::SocketSelector selector;
+	selector.add(listener);
+	std::vector<std::shared_ptr<Connection> > connections;
+	std::vector<char> buffer(1 << 16);
+	Batch batch;
+	PathRequest request;
+
+	while (true)
+	{
+		// the selector only reports sockets to read, so wake up now and then
+		// to retry results that did not fit in a socket's send buffer
+		bool ready = selector.wait(sf::milliseconds(RETRYMS));
+
+		for (int c = 0; c < (int)connections.size(); c++)
+		{
+			Connection & connection = *connections[c];
+			std::unique_lock<std::mutex> lock(connection.sendLock, std::defer_lock);
+			if (connection.backlogged || !connection.open)
+				lock.lock();
+			if (connection.backlogged)
+				Flush(connection);
+			if (!connection.open) {
+				// the client failed or stopped reading; workers still holding it skip it
+				selector.remove(connection.socket);
+				connection.socket.disconnect();
+				lock.unlock();
+				connections.erase(connections.begin() + c--);
+			}
+		}
+		if (!ready)
+			continue;
+
+		if (selector.isReady(listener)) {
+			std::shared_ptr<Connection> connection(new Connection);
+			if (listener.accept(connection->socket) == sf::Socket::Done) {
+				connection->socket.setBlocking(false);
+				selector.add(connection->socket);
+				connections.push_back(connection);
+			}
+		}
+
+		for (int c = 0; c < (int)connections.size(); c++)
+		{
+			Connection & connection = *connections[c];
+			if (!selector.isReady(connection.socket))
+				continue;
+
+			size_t received = 0;
+			sf::Socket::Status status = connection.socket.receive(&buffer[0], buffer.size(), received);
+			if (status == sf::Socket::NotReady)
+				continue;
+			if (status != sf::Socket::Done) {
+				// closed by the client; workers still holding it skip it
+				connection.open = false;
+				selector.remove(connection.socket);
+				connections.erase(connections.begin() + c--);
+				continue;
+			}
+
+			connection.incoming.append(&buffer[0], received);
+			while (connection.incoming.nextRequest(request))
+			{
+				batch.requests.push_back(request);
+				if ((int)batch.requests.size() == BATCHSIZE) {
+					batch.connection = connections[c];
+					queue.push(batch);
+				}
+			}
+			if (!batch.requests.empty()) {
+				batch.connection = connections[c];
+				queue.push(batch);
+			}
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
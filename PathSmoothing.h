@@ -0,0 +1,278 @@
+#ifndef PATHSMOOTHING_H
+#define PATHSMOOTHING_H
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "CompactGraph.h"
+#include "PriorityQueues.h"
+
+// ----------------------------------------------------------------
+//  Line of sight
+//
+//  Smoothing replaces runs of path nodes with a straight move
+//  wherever lineOfSight( a, b ) says the move is clear. The graph
+//  holds no obstacle data, so the test comes from the caller (a
+//  raycast against the level, say). The two below only count a
+//  move as clear when an arc joins the nodes, which suits
+//  navigation graphs whose arcs are the visible pairs.
+// ----------------------------------------------------------------
+struct ArcLineOfSight {
+    template<class Node>
+    bool operator()( Node* pFrom, Node* pTo ) const {
+        return pFrom->getArc( pTo ) != 0;
+    }
+};
+
+template<class ArcType>
+struct CompactLineOfSight {
+    CompactGraph<ArcType> const & m_graph;
+
+    explicit CompactLineOfSight( CompactGraph<ArcType> const & graph ) : m_graph( graph ) {}
+
+    bool operator()( int from, int to ) const {
+        for( int a = m_graph.begin( from ); a < m_graph.end( from ); a++ ) {
+            if( m_graph.target( a ) == to ) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           PositionDistance
+//  Description:    Straight line distance between two nodes of a
+//                  Graph, from getPosition().
+// ----------------------------------------------------------------
+template<class Graph>
+struct PositionDistance {
+    Graph const & m_graph;
+
+    explicit PositionDistance( Graph const & graph ) : m_graph( graph ) {}
+
+    double operator()( int from, int to ) const {
+        auto a = m_graph.nodeArray()[from]->getPosition();
+        auto b = m_graph.nodeArray()[to]->getPosition();
+        return std::sqrt( (double)( a.x - b.x ) * ( a.x - b.x ) + (double)( a.y - b.y ) * ( a.y - b.y ) );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           stringPull
+//  Description:    Straightens a path in place. From each kept node
+//                  the path skips ahead for as long as the next node
+//                  is still in sight, so zig-zags along arcs become
+//                  straight moves between corners. The path is only
+//                  ever shortened in its own buffer, so nothing is
+//                  allocated. Works on Graph paths (Node*) and on
+//                  AStarSearch paths (int) alike.
+//  Arguments:      The path and the line of sight test.
+//  Return Value:   The number of nodes removed.
+// ----------------------------------------------------------------
+template<class T, class LineOfSight>
+int stringPull( std::vector<T>& path, LineOfSight lineOfSight ) {
+    int n = (int)path.size();
+    if( n < 3 ) {
+        return 0;
+    }
+    int kept = 1;
+    for( int i = 1; i < n - 1; i++ ) {
+        // path[kept - 1] is the corner the path last turned at.
+        if( !lineOfSight( path[kept - 1], path[i + 1] ) ) {
+            path[kept++] = path[i];
+        }
+    }
+    path[kept++] = path[n - 1];
+    path.resize( kept );
+    return n - kept;
+}
+
+// ----------------------------------------------------------------
+//  Name:           ThetaStarSearch
+//  Description:    Any-angle search (Theta*) over a CompactGraph. It
+//                  runs like A*, except that a node reached from
+//                  another may take that node's parent as its own
+//                  when the two are in sight of each other, costed
+//                  at the straight line distance. The path it gives
+//                  is a list of corners joined by straight moves
+//                  rather than a chain of arcs.
+//
+//                  Lazy Theta* (set lazy) assumes sight when a node
+//                  is reached and only checks when the node is
+//                  expanded, falling back to its best expanded
+//                  neighbour if the check fails. That is one line
+//                  of sight test per expansion instead of one per
+//                  arc, which matters when the test is a raycast.
+//
+//                  distance( a, b ) must not exceed the cost of any
+//                  route between a and b (straight line distance
+//                  with arc weights of at least their length), so
+//                  it is used as the heuristic as well.
+// ----------------------------------------------------------------
+template<class ArcType>
+class ThetaStarSearch {
+private:
+    CompactGraph<ArcType> const & m_graph;
+
+// ----------------------------------------------------------------
+//  Description:    Cost and parent of every node, and whether it
+//                  has been expanded. Reset lazily as in
+//                  AStarSearch.
+// ----------------------------------------------------------------
+    std::vector<double> m_cost;
+    std::vector<int> m_parent;
+    std::vector<bool> m_closed;
+    std::vector<int> m_touched;
+
+    BinaryHeapQueue<double> m_queue;
+    bool m_lazy;
+    int m_expanded;
+    int m_sightTests;
+
+    void reset();
+
+public:
+    explicit ThetaStarSearch( CompactGraph<ArcType> const & graph, bool lazy = false )
+        : m_graph( graph ), m_lazy( lazy ), m_expanded( 0 ), m_sightTests( 0 ) {}
+
+    // Accessors
+    double cost( int node ) const {
+        return m_cost[node];
+    }
+
+    int parent( int node ) const {
+        return m_parent[node];
+    }
+
+    int expanded() const {
+        return m_expanded;
+    }
+
+    int sightTests() const {
+        return m_sightTests;
+    }
+
+    template<class Distance, class LineOfSight>
+    bool run( int start, int goal, Distance distance, LineOfSight lineOfSight, std::vector<int>& path );
+};
+
+// ----------------------------------------------------------------
+//  Name:           reset
+//  Description:    Sizes the arrays to the graph and clears the
+//                  entries the last query touched.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void ThetaStarSearch<ArcType>::reset() {
+    if( (int)m_cost.size() != m_graph.size() ) {
+        m_cost.assign( m_graph.size(), std::numeric_limits<double>::infinity() );
+        m_parent.assign( m_graph.size(), -1 );
+        m_closed.assign( m_graph.size(), false );
+    }
+    else {
+        for( int i = 0; i < (int)m_touched.size(); i++ ) {
+            m_cost[m_touched[i]] = std::numeric_limits<double>::infinity();
+            m_parent[m_touched[i]] = -1;
+            m_closed[m_touched[i]] = false;
+        }
+    }
+    m_touched.clear();
+    m_queue.clear();
+    m_expanded = 0;
+    m_sightTests = 0;
+}
+
+// ----------------------------------------------------------------
+//  Name:           run
+//  Description:    Finds an any-angle path from start to goal.
+//  Arguments:      The start and goal, the distance between two
+//                  nodes, the line of sight test and the path to
+//                  fill in with the corners, start first.
+//  Return Value:   true if the goal was reached.
+// ----------------------------------------------------------------
+template<class ArcType>
+template<class Distance, class LineOfSight>
+bool ThetaStarSearch<ArcType>::run( int start, int goal, Distance distance, LineOfSight lineOfSight, std::vector<int>& path ) {
+    reset();
+    path.clear();
+    if( start < 0 || goal < 0 || !m_graph.present( start ) || !m_graph.present( goal ) ) {
+        return false;
+    }
+
+    m_cost[start] = 0.0;
+    m_parent[start] = start;
+    m_touched.push_back( start );
+    m_queue.push( distance( start, goal ), start );
+
+    while( !m_queue.empty() ) {
+        double f;
+        int node = m_queue.pop( f );
+        if( m_closed[node] ) {
+            continue;
+        }
+
+        // lazy: make good the sight assumed when the node was reached.
+        if( m_lazy && node != start ) {
+            m_sightTests++;
+            if( !lineOfSight( m_parent[node], node ) ) {
+                m_cost[node] = std::numeric_limits<double>::infinity();
+                for( int a = m_graph.rbegin( node ); a < m_graph.rend( node ); a++ ) {
+                    int from = m_graph.source( a );
+                    double g = m_cost[from] + m_graph.rweight( a );
+                    if( m_closed[from] && g < m_cost[node] ) {
+                        m_cost[node] = g;
+                        m_parent[node] = from;
+                    }
+                }
+            }
+        }
+        m_closed[node] = true;
+        m_expanded++;
+
+        if( node == goal ) {
+            for( int at = goal; ; at = m_parent[at] ) {
+                path.push_back( at );
+                if( at == start ) {
+                    break;
+                }
+            }
+            std::reverse( path.begin(), path.end() );
+            return true;
+        }
+
+        int grandparent = m_parent[node];
+        for( int a = m_graph.begin( node ); a < m_graph.end( node ); a++ ) {
+            int child = m_graph.target( a );
+            if( m_closed[child] ) {
+                continue;
+            }
+            int from = node;
+            double g = m_cost[node] + m_graph.weight( a );
+            if( grandparent != node ) {
+                bool inSight = m_lazy;
+                if( !m_lazy ) {
+                    m_sightTests++;
+                    inSight = lineOfSight( grandparent, child );
+                }
+                if( inSight ) {
+                    from = grandparent;
+                    g = m_cost[grandparent] + distance( grandparent, child );
+                }
+            }
+            if( g < m_cost[child] ) {
+                if( m_cost[child] == std::numeric_limits<double>::infinity() ) {
+                    m_touched.push_back( child );
+                }
+                m_cost[child] = g;
+                m_parent[child] = from;
+                m_queue.push( g + distance( child, goal ), child );
+            }
+        }
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,290 @@
+#ifndef PRIORITYQUEUES_H
+#define PRIORITYQUEUES_H
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <cassert>
+
+// ----------------------------------------------------------------
+//  The queues the searches can be run with. They all hold (key,
+//  node) pairs and share one interface:
+//      void clear()
+//      bool empty() const
+//      void push( Cost key, int node )
+//      int pop( Cost& key )    - removes a smallest key
+//      size_t bytes() const    - memory held
+//  The radix heap and bucket queue are monotone: no key may be
+//  pushed below the last key popped. With a consistent heuristic A*
+//  never does that, so for A* and Dijkstra they find the same costs
+//  as the binary heap. A key that does fall below is a bug in the
+//  caller (an inconsistent heuristic, say); debug builds assert, and
+//  release builds raise it to the last key popped, which keeps the
+//  queue intact but pops the entry out of order.
+// ----------------------------------------------------------------
+
+// ----------------------------------------------------------------
+//  Name:           BinaryHeapQueue
+//  Description:    An array-based binary heap; works for any key.
+// ----------------------------------------------------------------
+template<class Cost>
+class BinaryHeapQueue {
+private:
+    typedef std::pair<Cost, int> Entry;
+    std::vector<Entry> m_heap;
+
+public:
+    void clear() {
+        m_heap.clear();
+    }
+
+    bool empty() const {
+        return m_heap.size() == 0;
+    }
+
+    void push( Cost key, int node ) {
+        m_heap.push_back( Entry( key, node ) );
+        std::push_heap( m_heap.begin(), m_heap.end(), std::greater<Entry>() );
+    }
+
+    int pop( Cost& key ) {
+        std::pop_heap( m_heap.begin(), m_heap.end(), std::greater<Entry>() );
+        key = m_heap.back().first;
+        int node = m_heap.back().second;
+        m_heap.pop_back();
+        return node;
+    }
+
+    size_t bytes() const {
+        return m_heap.capacity() * sizeof( Entry );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           RadixHeapQueue
+//  Description:    Monotone radix heap for integer keys. Bucket i
+//                  holds the keys whose highest bit differing from
+//                  the last popped key is bit i - 1 (bucket 0 holds
+//                  keys equal to it). Popping only has to look
+//                  inside the lowest non-empty bucket, and every
+//                  entry moves down at most once per bit, so each
+//                  push and pop is amortised O(bits), with no
+//                  comparisons between unrelated entries.
+// ----------------------------------------------------------------
+template<class Cost>
+class RadixHeapQueue {
+private:
+    static_assert( std::numeric_limits<Cost>::is_integer, "RadixHeapQueue needs integer keys" );
+
+    typedef unsigned long long Key;
+    typedef std::pair<Key, int> Entry;
+    enum { BUCKETS = 65 };
+
+    std::vector<Entry> m_buckets[BUCKETS];
+    Key m_last;
+    size_t m_size;
+
+    // number of bits needed to hold value.
+    static int bitLength( Key value ) {
+        int bits = 0;
+        if( value >> 32 ) { value >>= 32; bits += 32; }
+        if( value >> 16 ) { value >>= 16; bits += 16; }
+        if( value >> 8 ) { value >>= 8; bits += 8; }
+        if( value >> 4 ) { value >>= 4; bits += 4; }
+        if( value >> 2 ) { value >>= 2; bits += 2; }
+        if( value >> 1 ) { value >>= 1; bits += 1; }
+        return bits + (int)value;
+    }
+
+    int bucketOf( Key key ) const {
+        return bitLength( key ^ m_last );
+    }
+
+public:
+    RadixHeapQueue() : m_last( 0 ), m_size( 0 ) {}
+
+    void clear() {
+        for( int i = 0; i < BUCKETS; i++ ) {
+            m_buckets[i].clear();
+        }
+        m_last = 0;
+        m_size = 0;
+    }
+
+    bool empty() const {
+        return m_size == 0;
+    }
+
+    void push( Cost key, int node ) {
+        Key k = key > 0 ? (Key)key : 0;
+        assert( k >= m_last );
+        if( k < m_last ) {
+            k = m_last;
+        }
+        m_buckets[bucketOf( k )].push_back( Entry( k, node ) );
+        m_size++;
+    }
+
+    int pop( Cost& key ) {
+        if( m_buckets[0].size() == 0 ) {
+            // move the lowest non-empty bucket down around its minimum.
+            int i = 1;
+            while( m_buckets[i].size() == 0 ) {
+                i++;
+            }
+            std::vector<Entry>& bucket = m_buckets[i];
+            Key smallest = bucket[0].first;
+            for( size_t e = 1; e < bucket.size(); e++ ) {
+                if( bucket[e].first < smallest ) {
+                    smallest = bucket[e].first;
+                }
+            }
+            m_last = smallest;
+            for( size_t e = 0; e < bucket.size(); e++ ) {
+                m_buckets[bucketOf( bucket[e].first )].push_back( bucket[e] );
+            }
+            bucket.clear();
+        }
+        Entry entry = m_buckets[0].back();
+        m_buckets[0].pop_back();
+        m_size--;
+        key = (Cost)entry.first;
+        return entry.second;
+    }
+
+    size_t bytes() const {
+        size_t total = 0;
+        for( int i = 0; i < BUCKETS; i++ ) {
+            total += m_buckets[i].capacity() * sizeof( Entry );
+        }
+        return total;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           BucketQueue
+//  Description:    Dial's bucket queue for small integer keys: a
+//                  circular array with one bucket per key value.
+//                  Pushing is O(1); popping walks forward to the
+//                  next non-empty bucket. It needs more buckets than
+//                  the spread between the smallest and largest key
+//                  queued at once (about twice the largest arc
+//                  weight for A* with a Euclidean heuristic); the
+//                  ring doubles itself whenever a key falls outside.
+// ----------------------------------------------------------------
+template<class Cost>
+class BucketQueue {
+private:
+    static_assert( std::numeric_limits<Cost>::is_integer, "BucketQueue needs integer keys" );
+
+    typedef unsigned long long Key;
+    typedef std::pair<Key, int> Entry;
+
+    std::vector< std::vector<Entry> > m_buckets;
+    Key m_current;
+    size_t m_size;
+
+    void grow( Key span ) {
+        size_t size = m_buckets.size();
+        while( size <= span ) {
+            size *= 2;
+        }
+        std::vector< std::vector<Entry> > buckets( size );
+        for( size_t b = 0; b < m_buckets.size(); b++ ) {
+            for( size_t e = 0; e < m_buckets[b].size(); e++ ) {
+                buckets[m_buckets[b][e].first & ( size - 1 )].push_back( m_buckets[b][e] );
+            }
+        }
+        m_buckets.swap( buckets );
+    }
+
+public:
+    explicit BucketQueue( size_t buckets = 256 ) : m_current( 0 ), m_size( 0 ) {
+        size_t size = 1;
+        while( size < buckets ) {
+            size *= 2;
+        }
+        m_buckets.resize( size );
+    }
+
+    void clear() {
+        for( size_t b = 0; b < m_buckets.size(); b++ ) {
+            m_buckets[b].clear();
+        }
+        m_current = 0;
+        m_size = 0;
+    }
+
+    bool empty() const {
+        return m_size == 0;
+    }
+
+    void push( Cost key, int node ) {
+        Key k = key > 0 ? (Key)key : 0;
+        assert( k >= m_current );
+        if( k < m_current ) {
+            k = m_current;
+        }
+        if( k - m_current >= m_buckets.size() ) {
+            grow( k - m_current );
+        }
+        m_buckets[k & ( m_buckets.size() - 1 )].push_back( Entry( k, node ) );
+        m_size++;
+    }
+
+    int pop( Cost& key ) {
+        size_t mask = m_buckets.size() - 1;
+        while( m_buckets[m_current & mask].size() == 0 ) {
+            m_current++;
+        }
+        std::vector<Entry>& bucket = m_buckets[m_current & mask];
+        Entry entry = bucket.back();
+        bucket.pop_back();
+        m_size--;
+        key = (Cost)entry.first;
+        return entry.second;
+    }
+
+    size_t bytes() const {
+        size_t total = m_buckets.capacity() * sizeof( std::vector<Entry> );
+        for( size_t b = 0; b < m_buckets.size(); b++ ) {
+            total += m_buckets[b].capacity() * sizeof( Entry );
+        }
+        return total;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           DefaultQueue
+//  Description:    The binary heap, for every cost type. It is the
+//                  only queue that takes any admissible heuristic,
+//                  and the monotone ones gain little over it. On
+//                  QueueBench (A*, straight line heuristic) the radix
+//                  heap runs 1.1 to 1.3 times as fast on 120 x 120
+//                  and 300 x 300 grids, but 0.6 times as fast on the
+//                  30-node sample map. The bucket queue runs 1.4 to
+//                  1.6 times as fast on the grids and 0.3 times as
+//                  fast on the sample map.
+// ----------------------------------------------------------------
+template<class Cost>
+struct DefaultQueue {
+    typedef BinaryHeapQueue<Cost> Type;
+};
+
+// ----------------------------------------------------------------
+//  Name:           MonotoneQueue
+//  Description:    The radix heap for integer costs and the binary
+//                  heap for everything else. Only for searches whose
+//                  keys can never go down: Dijkstra, or A* with a
+//                  heuristic that is consistent by construction.
+// ----------------------------------------------------------------
+template<class Cost>
+struct MonotoneQueue {
+    typedef typename std::conditional< std::numeric_limits<Cost>::is_integer,
+                                       RadixHeapQueue<Cost>,
+                                       BinaryHeapQueue<Cost> >::type Type;
+};
+
+#endif
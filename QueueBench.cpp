@@ -0,0 +1,285 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+
+//standard c++ includes
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include "GraphLoader.h"
+#include "CompactGraph.h"
+#include "AStarSearch.h"
+#include "PriorityQueues.h"
+#include "GraphOrdering.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+using namespace std;
+
+// Microseconds from a fixed point. steady_clock in VS2013 only ticks with
+// the system clock, so Windows builds read the performance counter instead
+////////////////////////////
+long long NowMicros() {
+#ifdef _WIN32
+	LARGE_INTEGER frequency, now;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&now);
+	return now.QuadPart / frequency.QuadPart * 1000000 + now.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart;
+#else
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// A width x width grid, 100 units apart, with eight arcs per node. Arc
+// weights are the rounded-up length plus a random extra, so the straight
+// line distance stays a consistent heuristic
+////////////////////////////
+void MakeGrid(int width, unsigned seed, std::vector<NodeRecord> & nodes, std::vector<ArcRecord> & arcs) {
+	const int dx[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+	const int dy[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<int> extra(0, 39);
+
+	nodes.resize(width * width);
+	arcs.clear();
+	for (int y = 0; y < width; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			NodeRecord & node = nodes[y * width + x];
+			node.name = to_string(y * width + x);
+			node.x = x * 100;
+			node.y = y * 100;
+			for (int k = 0; k < 8; k++)
+			{
+				int nx = x + dx[k];
+				int ny = y + dy[k];
+				if (nx < 0 || ny < 0 || nx >= width || ny >= width)
+					continue;
+				ArcRecord arc = { y * width + x, ny * width + nx, (k < 4 ? 100 : 142) + extra(random) };
+				arcs.push_back(arc);
+			}
+		}
+	}
+}
+
+// Hands CompactGraph::build the arcs of a list in memory
+////////////////////////////
+struct ArcListSource {
+	std::vector<ArcRecord> const & m_arcs;
+
+	ArcListSource(std::vector<ArcRecord> const & arcs) : m_arcs(arcs) {}
+
+	template<class Visit>
+	bool operator()(Visit visit) {
+		for (size_t i = 0; i < m_arcs.size(); i++)
+			visit(m_arcs[i].from, m_arcs[i].to, m_arcs[i].weight);
+		return true;
+	}
+};
+
+// What one queue did over all the queries
+////////////////////////////
+struct QueueResult {
+	const char* name;
+	long long bestMicros;
+	long long expanded;
+	long long costSum;
+	std::vector<int> costs;
+};
+
+// Runs every query rounds times with one queue type and keeps the fastest
+// round, so the queues are compared on the same work
+////////////////////////////
+template<class Queue>
+QueueResult RunQueries(const char* name, CompactGraph<int> const & graph, std::vector<NodeRecord> const & nodes,
+	double heuristicScale, std::vector< std::pair<int, int> > const & queries, int rounds) {
+	AStarSearch<int, int, Queue> search(graph);
+	std::vector<int> path;
+	QueueResult result;
+	result.name = name;
+	result.bestMicros = -1;
+
+	for (int round = 0; round < rounds; round++)
+	{
+		result.expanded = 0;
+		result.costSum = 0;
+		result.costs.clear();
+		long long start = NowMicros();
+		for (size_t q = 0; q < queries.size(); q++)
+		{
+			int goal = queries[q].second;
+			bool found = search.run(queries[q].first, goal, RecordDistance(nodes, goal, heuristicScale), path);
+			result.expanded += search.expanded();
+			result.costs.push_back(found ? search.cost(goal) : -1);
+			result.costSum += found ? search.cost(goal) : 0;
+		}
+		long long micros = NowMicros() - start;
+		if (result.bestMicros < 0 || micros < result.bestMicros)
+			result.bestMicros = micros;
+	}
+	return result;
+}
+
+////////////////////////////////////////////////////////////
+/// Entry point of application
+//
+// QueueBench [--grid width] [--nodes file --arcs file] [--queries n]
+//            [--rounds n] [--seed n] [--order file|shuffled|rcm|hilbert]
+//
+// Times AStarSearch with each open list in PriorityQueues.h (binary
+// heap, radix heap, bucket queue) on the same random queries over the
+// same graph: a generated grid by default, or the graph in the node and
+// arc files. The heuristic is the straight line distance scaled down to
+// consistentScale, so that arcs shorter than their length (rounded-down
+// weights) cannot make it inconsistent, which the radix heap and bucket
+// queue need. --order renumbers the nodes first (GraphOrdering.h):
+// "shuffled" at random, as in a map file written in no particular order,
+// "rcm" by Cuthill-McKee and "hilbert" along a Hilbert curve; the default
+// keeps the file's order, which for the grid is row by row. The queries
+// are the same whatever the order, so runs with different orders compare
+// the time per expanded node on the same work. The grid and the queries
+// come from the seed, so a run can be repeated exactly. Each queue's fastest round is reported; the costs
+// found must agree, or the exit code is 1.
+////////////////////////////////////////////////////////////
+int main(int argc, char *argv[])
+{
+	int width = 300;
+	string nodesFile;
+	string arcsFile;
+	int queryCount = 200;
+	int rounds = 3;
+	unsigned seed = 1;
+	string order = "file";
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		string option = argv[i];
+		if (option == "--grid")
+			width = atoi(argv[i + 1]);
+		else if (option == "--nodes")
+			nodesFile = argv[i + 1];
+		else if (option == "--arcs")
+			arcsFile = argv[i + 1];
+		else if (option == "--queries")
+			queryCount = atoi(argv[i + 1]);
+		else if (option == "--rounds")
+			rounds = atoi(argv[i + 1]);
+		else if (option == "--seed")
+			seed = (unsigned)atoi(argv[i + 1]);
+		else if (option == "--order")
+			order = argv[i + 1];
+		else {
+			cout << "Unknown option " << option << endl;
+			return 1;
+		}
+	}
+	if (width < 2 || queryCount < 1 || rounds < 1 || nodesFile.empty() != arcsFile.empty()) {
+		cout << "Need a grid of at least 2, a query and a round, and both or neither of --nodes and --arcs" << endl;
+		return 1;
+	}
+	if (order != "file" && order != "shuffled" && order != "rcm" && order != "hilbert") {
+		cout << "Unknown order " << order << endl;
+		return 1;
+	}
+
+	// Build the graph
+	///////////////////////////
+	std::vector<NodeRecord> nodes;
+	CompactGraph<int> graph;
+	if (nodesFile.empty())
+	{
+		std::vector<ArcRecord> arcs;
+		MakeGrid(width, seed, nodes, arcs);
+		ArcListSource source(arcs);
+		graph.build((int)nodes.size(), source);
+	}
+	else
+	{
+		LoadErrors loadErrors;
+		if (!loadNodes(nodesFile.c_str(), nodes, loadErrors) || nodes.empty()) {
+			cout << "Could not read any nodes from " << nodesFile << endl;
+			loadErrors.print(cout);
+			return 1;
+		}
+		ArcFile arcs(arcsFile, (int)nodes.size(), loadErrors);
+		if (!graph.build((int)nodes.size(), arcs)) {
+			cout << "Could not read " << arcsFile << endl;
+			return 1;
+		}
+	}
+
+	std::mt19937 random(seed + 1);
+	std::uniform_int_distribution<int> pick(0, graph.size() - 1);
+	std::vector< std::pair<int, int> > queries(queryCount);
+	for (int q = 0; q < queryCount; q++)
+	{
+		queries[q].first = pick(random);
+		queries[q].second = pick(random);
+	}
+
+	// Renumber the nodes, and the queries and positions with them
+	///////////////////////////
+	NodeOrdering ordering;
+	if (order == "shuffled") {
+		std::vector<int> ids(graph.size());
+		iota(ids.begin(), ids.end(), 0);
+		shuffle(ids.begin(), ids.end(), std::mt19937(seed + 2));
+		ordering.setOrder(ids);
+	}
+	else if (order == "rcm")
+		cuthillMcKeeOrder(graph, ordering);
+	else if (order == "hilbert")
+		hilbertOrder(nodes, ordering);
+	if (ordering.size() > 0) {
+		CompactGraph<int> reordered;
+		reordered.build(graph, ordering.toInternal());
+		graph = reordered;
+		ordering.permute(nodes);
+		for (int q = 0; q < queryCount; q++)
+		{
+			queries[q].first = ordering.internal(queries[q].first);
+			queries[q].second = ordering.internal(queries[q].second);
+		}
+	}
+	double heuristicScale = consistentScale(nodes, graph);
+	cout << graph.size() << " nodes, " << graph.arcCount() << " arcs, " << queryCount << " queries, best of " << rounds << " rounds, seed " << seed
+		<< ", heuristic scale " << setprecision(6) << heuristicScale << ", " << order << " order" << endl;
+
+	// Time each queue
+	///////////////////////////
+	std::vector<QueueResult> results;
+	results.push_back(RunQueries< BinaryHeapQueue<int> >("binary heap", graph, nodes, heuristicScale, queries, rounds));
+	results.push_back(RunQueries< RadixHeapQueue<int> >("radix heap", graph, nodes, heuristicScale, queries, rounds));
+	results.push_back(RunQueries< BucketQueue<int> >("bucket queue", graph, nodes, heuristicScale, queries, rounds));
+
+	bool agree = true;
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		QueueResult const & result = results[i];
+		cout << left << setw(14) << result.name << right << fixed << setprecision(1)
+			<< setw(10) << result.bestMicros / 1000.0 << " ms"
+			<< setw(10) << (double)result.bestMicros / queryCount << " us/query"
+			<< setw(12) << result.expanded << " expanded"
+			<< setw(8) << result.bestMicros * 1000.0 / max(result.expanded, 1LL) << " ns/expanded"
+			<< "   cost sum " << result.costSum
+			<< "   x" << setprecision(2) << (double)results[0].bestMicros / max(result.bestMicros, 1LL) << endl;
+		if (result.costs != results[0].costs)
+			agree = false;
+	}
+	if (!agree) {
+		cout << "The queues found different costs" << endl;
+		return 1;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,275 @@
+#ifndef REACHABILITY_H
+#define REACHABILITY_H
+
+#include <vector>
+#include <atomic>
+#include "CompactGraph.h"
+#include "Parallel.h"
+
+// ----------------------------------------------------------------
+//  Name:           parallelBreadthFirst
+//  Description:    Direction-optimizing breadth-first search over a
+//                  CompactGraph. Small frontiers are expanded top-
+//                  down (each frontier node claims its unvisited
+//                  children through an atomic visited bitmap).
+//                  Once the frontier's arcs outnumber the unvisited
+//                  arcs / 14 it switches to bottom-up (each
+//                  unvisited node looks for a parent in the
+//                  frontier), and back again when the frontier
+//                  shrinks below nodes / 24. Does not touch the
+//                  marks on the Graph's nodes, so any number of
+//                  searches can run at the same time.
+//  Arguments:      The graph, the starting node, the depth array to
+//                  fill in (-1 for unreached nodes) and the number
+//                  of threads (0 for all cores).
+//  Return Value:   The number of nodes reached, including the start.
+// ----------------------------------------------------------------
+template<class ArcType>
+int parallelBreadthFirst( CompactGraph<ArcType> const & graph, int start, std::vector<int>& depth, int threads = 0 ) {
+    const int ALPHA = 14;
+    const int BETA = 24;
+
+    int n = graph.size();
+    depth.assign( n, -1 );
+    if( start < 0 || start >= n || !graph.present( start ) ) {
+        return 0;
+    }
+    if( threads <= 0 ) {
+        threads = hardwareThreads();
+    }
+
+    AtomicBitmap visited( n );
+    AtomicBitmap inFrontier;
+    std::vector<int> frontier( 1, start );
+    std::vector< std::vector<int> > next( threads );
+    visited.set( start );
+    depth[start] = 0;
+
+    int reached = 1;
+    int level = 0;
+    long long unexploredArcs = graph.arcCount() - graph.degree( start );
+    bool bottomUp = false;
+
+    while( frontier.size() != 0 ) {
+        // pick the direction for this level.
+        long long frontierArcs = 0;
+        for( int i = 0; i < (int)frontier.size(); i++ ) {
+            frontierArcs += graph.degree( frontier[i] );
+        }
+        if( !bottomUp && frontierArcs > unexploredArcs / ALPHA ) {
+            bottomUp = true;
+        } else if( bottomUp && (long long)frontier.size() < n / BETA ) {
+            bottomUp = false;
+        }
+
+        for( int t = 0; t < threads; t++ ) {
+            next[t].clear();
+        }
+
+        if( bottomUp == false ) {
+            // top-down: children are claimed by whichever thread sets their bit.
+            parallelFor( 0, (int)frontier.size(), [&]( int lo, int hi, int t ) {
+                for( int i = lo; i < hi; i++ ) {
+                    int node = frontier[i];
+                    for( int a = graph.begin( node ); a < graph.end( node ); a++ ) {
+                        int child = graph.target( a );
+                        if( visited.testAndSet( child ) ) {
+                            depth[child] = level + 1;
+                            next[t].push_back( child );
+                        }
+                    }
+                }
+            }, threads, 256 );
+        } else {
+            // bottom-up: each unvisited node only writes itself, so no claiming is needed.
+            inFrontier.reset( n );
+            for( int i = 0; i < (int)frontier.size(); i++ ) {
+                inFrontier.set( frontier[i] );
+            }
+            parallelFor( 0, n, [&]( int lo, int hi, int t ) {
+                for( int node = lo; node < hi; node++ ) {
+                    if( visited.test( node ) || !graph.present( node ) ) {
+                        continue;
+                    }
+                    for( int a = graph.rbegin( node ); a < graph.rend( node ); a++ ) {
+                        if( inFrontier.test( graph.source( a ) ) ) {
+                            visited.set( node );
+                            depth[node] = level + 1;
+                            next[t].push_back( node );
+                            break;
+                        }
+                    }
+                }
+            }, threads, 4096 );
+        }
+
+        // gather the next frontier.
+        frontier.clear();
+        for( int t = 0; t < threads; t++ ) {
+            frontier.insert( frontier.end(), next[t].begin(), next[t].end() );
+        }
+        for( int i = 0; i < (int)frontier.size(); i++ ) {
+            unexploredArcs -= graph.degree( frontier[i] );
+        }
+        reached += (int)frontier.size();
+        level++;
+    }
+
+    return reached;
+}
+
+// ----------------------------------------------------------------
+//  Name:           ReachabilityIndex
+//  Description:    Labels every node with its connected component
+//                  (ignoring arc direction) so that "can B be
+//                  reached from A" is answered with one comparison
+//                  before any search is started. If every arc has a
+//                  matching arc back, as in nodes.txt / arcs.txt,
+//                  the answer is exact. With one-way arcs a
+//                  different label still proves B is unreachable,
+//                  but the same label only means it might be.
+// ----------------------------------------------------------------
+template<class ArcType>
+class ReachabilityIndex {
+private:
+
+// ----------------------------------------------------------------
+//  Description:    Component of each node, numbered from 0.
+//                  -1 for indices that hold no node.
+// ----------------------------------------------------------------
+    std::vector<int> m_component;
+
+// ----------------------------------------------------------------
+//  Description:    The number of components.
+// ----------------------------------------------------------------
+    int m_components;
+
+// ----------------------------------------------------------------
+//  Description:    true if every arc has a reverse arc.
+// ----------------------------------------------------------------
+    bool m_symmetric;
+
+    static int findRoot( std::vector< std::atomic<int> >& parent, int node );
+
+public:
+    ReachabilityIndex() : m_components( 0 ), m_symmetric( true ) {}
+
+    explicit ReachabilityIndex( CompactGraph<ArcType> const & graph, int threads = 0 ) {
+        build( graph, threads );
+    }
+
+    void build( CompactGraph<ArcType> const & graph, int threads = 0 );
+
+    // Accessors
+    int component( int node ) const {
+        return m_component[node];
+    }
+
+    int componentCount() const {
+        return m_components;
+    }
+
+    bool exact() const {
+        return m_symmetric;
+    }
+
+    // false means the goal can never be reached from the start.
+    bool mayReach( int from, int to ) const {
+        return m_component[from] != -1 && m_component[from] == m_component[to];
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           findRoot
+//  Description:    Finds the root of a node in the union-find
+//                  forest, halving the path on the way up. Only
+//                  ever points a node at one of its ancestors, so
+//                  it is safe to run while other threads link roots.
+//  Arguments:      The parent array and the node.
+//  Return Value:   The root.
+// ----------------------------------------------------------------
+template<class ArcType>
+int ReachabilityIndex<ArcType>::findRoot( std::vector< std::atomic<int> >& parent, int node ) {
+    int p = parent[node].load( std::memory_order_relaxed );
+    while( p != node ) {
+        int gp = parent[p].load( std::memory_order_relaxed );
+        if( gp != p ) {
+            parent[node].store( gp, std::memory_order_relaxed );
+        }
+        node = p;
+        p = parent[node].load( std::memory_order_relaxed );
+    }
+    return node;
+}
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Labels the components. Arcs are split between
+//                  threads and joined with a lock-free union-find
+//                  (the larger root is always linked under the
+//                  smaller one with a compare-and-swap), then the
+//                  roots are numbered.
+//  Arguments:      The graph and the number of threads.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void ReachabilityIndex<ArcType>::build( CompactGraph<ArcType> const & graph, int threads ) {
+    int n = graph.size();
+    std::vector< std::atomic<int> > parent( n );
+    for( int i = 0; i < n; i++ ) {
+        parent[i].store( i, std::memory_order_relaxed );
+    }
+
+    parallelFor( 0, n, [&]( int lo, int hi, int ) {
+        for( int node = lo; node < hi; node++ ) {
+            for( int a = graph.begin( node ); a < graph.end( node ); a++ ) {
+                int u = node;
+                int v = graph.target( a );
+                while( true ) {
+                    u = findRoot( parent, u );
+                    v = findRoot( parent, v );
+                    if( u == v ) {
+                        break;
+                    }
+                    if( u < v ) {
+                        int swap = u;
+                        u = v;
+                        v = swap;
+                    }
+                    int expected = u;
+                    if( parent[u].compare_exchange_strong( expected, v ) ) {
+                        break;
+                    }
+                }
+            }
+        }
+    }, threads, 4096 );
+
+    // number the roots in node order.
+    m_component.assign( n, -1 );
+    m_components = 0;
+    for( int i = 0; i < n; i++ ) {
+        if( graph.present( i ) ) {
+            int root = findRoot( parent, i );
+            if( m_component[root] == -1 ) {
+                m_component[root] = m_components++;
+            }
+            m_component[i] = m_component[root];
+        }
+    }
+
+    // the labels are only exact if every arc can be walked back.
+    m_symmetric = true;
+    for( int node = 0; node < n && m_symmetric; node++ ) {
+        for( int a = graph.begin( node ); a < graph.end( node ) && m_symmetric; a++ ) {
+            int v = graph.target( a );
+            bool found = false;
+            for( int b = graph.begin( v ); b < graph.end( v ) && !found; b++ ) {
+                found = graph.target( b ) == node;
+            }
+            m_symmetric = found;
+        }
+    }
+}
+
+#endif
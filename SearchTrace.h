@@ -0,0 +1,348 @@
+#ifndef SEARCHTRACE_H
+#define SEARCHTRACE_H
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include "CompactGraph.h"
+#include "CostTraits.h"
+#include "AStarSearch.h"
+
+// ----------------------------------------------------------------
+//  Name:           graphFingerprint
+//  Description:    A 64 bit hash (FNV-1a) of a graph's arcs and
+//                  weights. A trace records it so a replay can tell
+//                  whether it is running on the same graph.
+//  Arguments:      The graph.
+//  Return Value:   The hash.
+// ----------------------------------------------------------------
+template<class ArcType>
+unsigned long long graphFingerprint( CompactGraph<ArcType> const & graph ) {
+    unsigned long long hash = 14695981039346656037ULL;
+    struct Mix {
+        static void in( unsigned long long& hash, unsigned long long value ) {
+            for( int i = 0; i < 8; i++ ) {
+                hash ^= ( value >> ( i * 8 ) ) & 0xff;
+                hash *= 1099511628211ULL;
+            }
+        }
+    };
+    Mix::in( hash, (unsigned long long)graph.size() );
+    for( int node = 0; node < graph.size(); node++ ) {
+        Mix::in( hash, graph.present( node ) ? graph.degree( node ) + 1 : 0 );
+        for( int a = graph.begin( node ); a < graph.end( node ); a++ ) {
+            Mix::in( hash, (unsigned long long)graph.target( a ) );
+            Mix::in( hash, (unsigned long long)(long long)std::floor( (double)graph.weight( a ) * 1024.0 ) );
+        }
+    }
+    return hash;
+}
+
+// ----------------------------------------------------------------
+//  Name:           SearchTrace
+//  Description:    One query as it ran: what was asked (the graph
+//                  it ran on, the start, goal and scales), what came
+//                  back, and the order the nodes were expanded in
+//                  with their costs. Expansions are stored as
+//                  variable length deltas from the one before, which
+//                  is usually one or two bytes each.
+//
+//                  Costs are recorded in whole search units (arc
+//                  weight times the cost scale).
+// ----------------------------------------------------------------
+class SearchTrace {
+private:
+    enum { MAGIC = 0x31525450 };    // "PTR1"
+
+    std::vector<unsigned char> m_events;
+    int m_lastNode;
+    long long m_lastCost;
+
+    static void putVarint( std::vector<unsigned char>& out, unsigned long long value ) {
+        while( value >= 0x80 ) {
+            out.push_back( (unsigned char)( value | 0x80 ) );
+            value >>= 7;
+        }
+        out.push_back( (unsigned char)value );
+    }
+
+    static bool getVarint( const unsigned char*& p, const unsigned char* end, unsigned long long& value ) {
+        value = 0;
+        for( int shift = 0; p != end && shift < 64; shift += 7 ) {
+            unsigned char byte = *p++;
+            value |= (unsigned long long)( byte & 0x7f ) << shift;
+            if( ( byte & 0x80 ) == 0 ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // signed values are zig-zag encoded so small negatives stay small.
+    static unsigned long long zigzag( long long value ) {
+        return ( (unsigned long long)value << 1 ) ^ (unsigned long long)( value >> 63 );
+    }
+
+    static long long unzigzag( unsigned long long value ) {
+        return (long long)( value >> 1 ) ^ -(long long)( value & 1 );
+    }
+
+    // scales are kept bit for bit so a replay searches exactly alike.
+    static unsigned long long doubleBits( double value ) {
+        unsigned long long bits;
+        std::memcpy( &bits, &value, sizeof( bits ) );
+        return bits;
+    }
+
+    static double bitsDouble( unsigned long long bits ) {
+        double value;
+        std::memcpy( &value, &bits, sizeof( value ) );
+        return value;
+    }
+
+public:
+    unsigned queryId;
+    unsigned long long graphHash;
+    unsigned graphVersion;
+    int start;
+    int goal;
+    double heuristicScale;
+    double costScale;
+    bool found;
+    long long cost;
+    int expansions;
+
+    SearchTrace() {
+        clear();
+    }
+
+    void clear() {
+        m_events.clear();
+        m_lastNode = 0;
+        m_lastCost = 0;
+        queryId = 0;
+        graphHash = 0;
+        graphVersion = 0;
+        start = -1;
+        goal = -1;
+        heuristicScale = 1.0;
+        costScale = 1.0;
+        found = false;
+        cost = 0;
+        expansions = 0;
+    }
+
+    // Records an expansion.
+    void expand( int node, long long g ) {
+        putVarint( m_events, zigzag( (long long)node - m_lastNode ) );
+        putVarint( m_events, zigzag( g - m_lastCost ) );
+        m_lastNode = node;
+        m_lastCost = g;
+        expansions++;
+    }
+
+    // Decodes every expansion, in order.
+    bool events( std::vector<int>& nodes, std::vector<long long>& costs ) const {
+        nodes.clear();
+        costs.clear();
+        const unsigned char* p = m_events.empty() ? 0 : &m_events[0];
+        const unsigned char* end = p + m_events.size();
+        long long node = 0;
+        long long g = 0;
+        unsigned long long value;
+        while( p != end ) {
+            if( !getVarint( p, end, value ) ) {
+                return false;
+            }
+            node += unzigzag( value );
+            if( !getVarint( p, end, value ) ) {
+                return false;
+            }
+            g += unzigzag( value );
+            nodes.push_back( (int)node );
+            costs.push_back( g );
+        }
+        return (int)nodes.size() == expansions;
+    }
+
+    size_t bytes() const {
+        return m_events.size();
+    }
+
+    void write( std::ostream& out ) const;
+    bool read( std::istream& in );
+};
+
+// ----------------------------------------------------------------
+//  Name:           write / read
+//  Description:    Saves and loads a trace. Traces are appended to
+//                  a file one after another; read returns false at
+//                  the end of the file or on a damaged record.
+// ----------------------------------------------------------------
+inline void SearchTrace::write( std::ostream& out ) const {
+    std::vector<unsigned char> header;
+    putVarint( header, MAGIC );
+    putVarint( header, queryId );
+    putVarint( header, graphHash );
+    putVarint( header, graphVersion );
+    putVarint( header, zigzag( start ) );
+    putVarint( header, zigzag( goal ) );
+    putVarint( header, doubleBits( heuristicScale ) );
+    putVarint( header, doubleBits( costScale ) );
+    putVarint( header, found ? 1 : 0 );
+    putVarint( header, zigzag( cost ) );
+    putVarint( header, (unsigned long long)expansions );
+    putVarint( header, m_events.size() );
+    out.write( (const char*)&header[0], header.size() );
+    if( !m_events.empty() ) {
+        out.write( (const char*)&m_events[0], m_events.size() );
+    }
+}
+
+inline bool SearchTrace::read( std::istream& in ) {
+    clear();
+    unsigned long long fields[12];
+    for( int i = 0; i < 12; i++ ) {
+        fields[i] = 0;
+        for( int shift = 0; ; shift += 7 ) {
+            int byte = in.get();
+            if( byte == EOF || shift >= 64 ) {
+                return false;
+            }
+            fields[i] |= (unsigned long long)( byte & 0x7f ) << shift;
+            if( ( byte & 0x80 ) == 0 ) {
+                break;
+            }
+        }
+    }
+    if( fields[0] != MAGIC ) {
+        return false;
+    }
+    queryId = (unsigned)fields[1];
+    graphHash = fields[2];
+    graphVersion = (unsigned)fields[3];
+    start = (int)unzigzag( fields[4] );
+    goal = (int)unzigzag( fields[5] );
+    heuristicScale = bitsDouble( fields[6] );
+    costScale = bitsDouble( fields[7] );
+    found = fields[8] != 0;
+    cost = unzigzag( fields[9] );
+    expansions = (int)fields[10];
+    m_events.resize( (size_t)fields[11] );
+    if( !m_events.empty() ) {
+        in.read( (char*)&m_events[0], m_events.size() );
+    }
+    return (size_t)in.gcount() == m_events.size() || m_events.empty();
+}
+
+// ----------------------------------------------------------------
+//  Name:           TraceRecorder
+//  Description:    An AStarSearch observer that writes each
+//                  expansion into a trace.
+// ----------------------------------------------------------------
+struct TraceRecorder {
+    SearchTrace& m_trace;
+
+    explicit TraceRecorder( SearchTrace& trace ) : m_trace( trace ) {}
+
+    template<class Cost>
+    void expand( int node, Cost g ) {
+        m_trace.expand( node, (long long)std::floor( CostTraits<Cost>::toDouble( g ) + 0.5 ) );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           TraceSampler
+//  Description:    Picks which queries to trace: about one in every
+//                  "every" (0 for none), chosen by hashing the query
+//                  number so the choice does not line up with any
+//                  pattern in the requests.
+// ----------------------------------------------------------------
+class TraceSampler {
+private:
+    unsigned m_every;
+
+public:
+    explicit TraceSampler( unsigned every = 0 ) : m_every( every ) {}
+
+    bool sample( unsigned long long query ) const {
+        if( m_every == 0 ) {
+            return false;
+        }
+        query ^= query >> 33;
+        query *= 0xff51afd7ed558ccdULL;
+        query ^= query >> 33;
+        return query % m_every == 0;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           tracedRun
+//  Description:    Runs a query and records it. The trace's start,
+//                  goal and scales are filled in from the arguments.
+//  Arguments:      The search, the graph fingerprint, the start and
+//                  goal, the heuristic and its scale, the path to
+//                  fill in and the trace to record into.
+//  Return Value:   true if the goal was reached.
+// ----------------------------------------------------------------
+template<class Search, class Heuristic>
+bool tracedRun( Search& search, unsigned long long graphHash, int start, int goal, Heuristic heuristic, double heuristicScale,
+                std::vector<int>& path, SearchTrace& trace ) {
+    unsigned queryId = trace.queryId;
+    unsigned graphVersion = trace.graphVersion;
+    trace.clear();
+    trace.queryId = queryId;
+    trace.graphVersion = graphVersion;
+    trace.graphHash = graphHash;
+    trace.start = start;
+    trace.goal = goal;
+    trace.heuristicScale = heuristicScale;
+    trace.costScale = search.scale();
+
+    TraceRecorder recorder( trace );
+    trace.found = search.run( start, goal, heuristic, path, recorder );
+    trace.cost = trace.found ? (long long)std::floor( CostTraits<typename Search::CostType>::toDouble( search.cost( goal ) ) + 0.5 ) : 0;
+    return trace.found;
+}
+
+// ----------------------------------------------------------------
+//  Name:           diffTraces
+//  Description:    Compares a recorded trace with a replay of it.
+//  Arguments:      The two traces.
+//  Return Value:   An empty string if they match, else a description
+//                  of the first difference.
+// ----------------------------------------------------------------
+inline std::string diffTraces( SearchTrace const & recorded, SearchTrace const & replayed ) {
+    std::ostringstream diff;
+    if( recorded.graphHash != replayed.graphHash ) {
+        diff << "graph differs (recorded on " << std::hex << recorded.graphHash << ", replayed on " << replayed.graphHash << ")";
+        return diff.str();
+    }
+    std::vector<int> nodesA, nodesB;
+    std::vector<long long> costsA, costsB;
+    if( !recorded.events( nodesA, costsA ) || !replayed.events( nodesB, costsB ) ) {
+        return "trace is damaged";
+    }
+    for( int i = 0; i < (int)nodesA.size() && i < (int)nodesB.size(); i++ ) {
+        if( nodesA[i] != nodesB[i] || costsA[i] != costsB[i] ) {
+            diff << "expansion " << i << ": recorded node " << nodesA[i] << " at cost " << costsA[i]
+                 << ", replay expanded node " << nodesB[i] << " at cost " << costsB[i];
+            return diff.str();
+        }
+    }
+    if( nodesA.size() != nodesB.size() ) {
+        diff << "recorded " << nodesA.size() << " expansions, replay made " << nodesB.size();
+        return diff.str();
+    }
+    if( recorded.found != replayed.found || recorded.cost != replayed.cost ) {
+        diff << "recorded result " << ( recorded.found ? "found" : "none" ) << " at cost " << recorded.cost
+             << ", replay gave " << ( replayed.found ? "found" : "none" ) << " at cost " << replayed.cost;
+        return diff.str();
+    }
+    return "";
+}
+
+#endif
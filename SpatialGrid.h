@@ -0,0 +1,427 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <vector>
+#include <unordered_map>
+#include <cmath>
+#include <algorithm>
+#include "SFML/System/Vector2.hpp"
+
+// ----------------------------------------------------------------
+//  Name:           SpatialGrid
+//  Description:    A uniform grid of buckets over node positions.
+//                  Each bucket holds the ids of the nodes inside one
+//                  cell, so inserting and removing a node only
+//                  touches one bucket, and a query only looks at
+//                  the cells around the point asked about. Nearest-
+//                  node searches walk outwards ring by ring, only
+//                  over cells inside the range that holds nodes, and
+//                  stop as soon as no unvisited cell could hold
+//                  anything closer.
+//
+//                  Unless a cell size is given, the grid sizes its
+//                  cells to the nodes: each time the node count
+//                  doubles it picks a size that puts about two
+//                  nodes in a cell of their bounding box and
+//                  rebuilds, so with roughly even density a query
+//                  looks at a constant number of cells whatever the
+//                  spacing of the map.
+// ----------------------------------------------------------------
+class SpatialGrid {
+private:
+    typedef std::unordered_map< long long, std::vector<int> > CellMap;
+
+// ----------------------------------------------------------------
+//  Description:    Width and height of a cell in world units, and
+//                  whether fit() picks it, once the node count
+//                  reaches m_fitAt.
+// ----------------------------------------------------------------
+    float m_cellSize;
+    bool m_autoFit;
+    int m_fitAt;
+
+// ----------------------------------------------------------------
+//  Description:    The non-empty cells, keyed by cell coordinates.
+// ----------------------------------------------------------------
+    CellMap m_cells;
+
+// ----------------------------------------------------------------
+//  Description:    Position of each node id, and whether it is in
+//                  the grid.
+// ----------------------------------------------------------------
+    std::vector<sf::Vector2f> m_positions;
+    std::vector<bool> m_present;
+    int m_count;
+
+// ----------------------------------------------------------------
+//  Description:    Range of cells that have ever held a node; the
+//                  nearest-node search never has to look past it.
+// ----------------------------------------------------------------
+    int m_minX, m_minY, m_maxX, m_maxY;
+
+    int cellOf( float value ) const {
+        return (int)floor( value / m_cellSize );
+    }
+
+    static long long key( int x, int y ) {
+        return ( (long long)x << 32 ) ^ (unsigned)y;
+    }
+
+    void addToCell( int id );
+    void scanCell( int x, int y, sf::Vector2f point, float& bestDistance, int& best ) const;
+
+public:
+    // A cell size of zero or less lets the grid choose it.
+    explicit SpatialGrid( float cellSize = 0.0f )
+        : m_cellSize( cellSize > 0.0f ? cellSize : 64.0f ), m_autoFit( cellSize <= 0.0f ), m_fitAt( 64 ),
+          m_count( 0 ), m_minX( 0 ), m_minY( 0 ), m_maxX( -1 ), m_maxY( -1 ) {}
+
+    // Accessors
+    int size() const {
+        return m_count;
+    }
+
+    bool contains( int id ) const {
+        return id >= 0 && id < (int)m_present.size() && m_present[id];
+    }
+
+    sf::Vector2f position( int id ) const {
+        return m_positions[id];
+    }
+
+    float cellSize() const {
+        return m_cellSize;
+    }
+
+    // Public member functions.
+    void insert( int id, sf::Vector2f position );
+    void remove( int id );
+    void move( int id, sf::Vector2f position );
+    void clear();
+    void fit();
+    size_t bytes() const;
+    int nearest( sf::Vector2f point, float maxDistance = -1.0f ) const;
+    void inRadius( sf::Vector2f point, float radius, std::vector<int>& found ) const;
+    void inBox( sf::Vector2f lo, sf::Vector2f hi, std::vector<int>& found ) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           insert
+//  Description:    Adds a node to the grid. A node already in the
+//                  grid is moved instead.
+//  Arguments:      The node id and its position.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialGrid::insert( int id, sf::Vector2f position ) {
+    if( contains( id ) ) {
+        move( id, position );
+        return;
+    }
+    if( id >= (int)m_present.size() ) {
+        m_present.resize( id + 1, false );
+        m_positions.resize( id + 1 );
+    }
+
+    m_positions[id] = position;
+    m_present[id] = true;
+    addToCell( id );
+    m_count++;
+
+    if( m_autoFit && m_count >= m_fitAt ) {
+        fit();
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           addToCell
+//  Description:    Puts a node into the bucket for its position and
+//                  widens the range of occupied cells to take it.
+//  Arguments:      The node id.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialGrid::addToCell( int id ) {
+    int x = cellOf( m_positions[id].x );
+    int y = cellOf( m_positions[id].y );
+    m_cells[key( x, y )].push_back( id );
+
+    if( m_maxX < m_minX ) {
+        m_minX = m_maxX = x;
+        m_minY = m_maxY = y;
+    }
+    if( x < m_minX ) m_minX = x;
+    if( x > m_maxX ) m_maxX = x;
+    if( y < m_minY ) m_minY = y;
+    if( y > m_maxY ) m_maxY = y;
+}
+
+// ----------------------------------------------------------------
+//  Name:           remove
+//  Description:    Takes a node out of the grid.
+//  Arguments:      The node id.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialGrid::remove( int id ) {
+    if( !contains( id ) ) {
+        return;
+    }
+    long long cell = key( cellOf( m_positions[id].x ), cellOf( m_positions[id].y ) );
+    CellMap::iterator found = m_cells.find( cell );
+    std::vector<int>& bucket = found->second;
+    for( int i = 0; i < (int)bucket.size(); i++ ) {
+        if( bucket[i] == id ) {
+            bucket[i] = bucket.back();
+            bucket.pop_back();
+            break;
+        }
+    }
+    if( bucket.size() == 0 ) {
+        m_cells.erase( found );
+    }
+    m_present[id] = false;
+    m_count--;
+}
+
+// ----------------------------------------------------------------
+//  Name:           move
+//  Description:    Moves a node already in the grid.
+//  Arguments:      The node id and its new position.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialGrid::move( int id, sf::Vector2f position ) {
+    remove( id );
+    insert( id, position );
+}
+
+// ----------------------------------------------------------------
+//  Name:           clear
+//  Description:    Empties the grid.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialGrid::clear() {
+    m_cells.clear();
+    m_positions.clear();
+    m_present.clear();
+    m_count = 0;
+    m_fitAt = 64;
+    m_minX = m_minY = 0;
+    m_maxX = m_maxY = -1;
+}
+
+// ----------------------------------------------------------------
+//  Name:           fit
+//  Description:    Resizes the cells to the nodes in the grid, about
+//                  two nodes to a cell over their bounding box (or
+//                  along it, if the nodes lie in a line), and puts
+//                  every node back into the new cells. Called by
+//                  insert() as the grid grows, unless it was made
+//                  with a fixed cell size; call it after a bulk
+//                  load or a large removal for a fixed-size grid.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialGrid::fit() {
+    m_fitAt = std::max( 64, 2 * m_count );
+    if( m_count == 0 ) {
+        return;
+    }
+
+    sf::Vector2f lo, hi;
+    bool first = true;
+    for( int id = 0; id < (int)m_present.size(); id++ ) {
+        if( !m_present[id] ) {
+            continue;
+        }
+        sf::Vector2f p = m_positions[id];
+        if( first ) {
+            lo = hi = p;
+            first = false;
+        }
+        lo.x = std::min( lo.x, p.x );
+        lo.y = std::min( lo.y, p.y );
+        hi.x = std::max( hi.x, p.x );
+        hi.y = std::max( hi.y, p.y );
+    }
+    float width = hi.x - lo.x;
+    float height = hi.y - lo.y;
+    float size = width * height > 0.0f ? std::sqrt( 2.0f * width * height / m_count )
+                                       : 2.0f * std::max( width, height ) / m_count;
+    if( !( size > 0.0f ) ) {
+        return;     // every node on one point; any size will do.
+    }
+
+    m_cellSize = size;
+    m_cells.clear();
+    m_minX = m_minY = 0;
+    m_maxX = m_maxY = -1;
+    for( int id = 0; id < (int)m_present.size(); id++ ) {
+        if( m_present[id] ) {
+            addToCell( id );
+        }
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           bytes
+//  Description:    Estimates the memory the grid holds: the per-id
+//                  arrays, the hash table's buckets and entries
+//                  (each entry a separate list node) and the cells'
+//                  id vectors.
+//  Arguments:      None.
+//  Return Value:   The size in bytes.
+// ----------------------------------------------------------------
+inline size_t SpatialGrid::bytes() const {
+    size_t total = m_positions.capacity() * sizeof( sf::Vector2f ) + m_present.capacity() / 8
+                 + m_cells.bucket_count() * sizeof( void* )
+                 + m_cells.size() * ( sizeof( CellMap::value_type ) + 2 * sizeof( void* ) );
+    for( CellMap::const_iterator cell = m_cells.begin(); cell != m_cells.end(); ++cell ) {
+        total += cell->second.capacity() * sizeof( int );
+    }
+    return total;
+}
+
+// ----------------------------------------------------------------
+//  Name:           scanCell
+//  Description:    Checks every node in one cell against the best
+//                  found so far.
+//  Arguments:      The cell, the query point, the best squared
+//                  distance and best id so far (both updated).
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialGrid::scanCell( int x, int y, sf::Vector2f point, float& bestDistance, int& best ) const {
+    CellMap::const_iterator found = m_cells.find( key( x, y ) );
+    if( found == m_cells.end() ) {
+        return;
+    }
+    std::vector<int> const & bucket = found->second;
+    for( int i = 0; i < (int)bucket.size(); i++ ) {
+        sf::Vector2f d = m_positions[bucket[i]] - point;
+        float distance = d.x * d.x + d.y * d.y;
+        if( best == -1 || distance < bestDistance ) {
+            bestDistance = distance;
+            best = bucket[i];
+        }
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           nearest
+//  Description:    Finds the node closest to a point. Looks at the
+//                  point's cell, then each surrounding ring of cells
+//                  in turn, until the next ring is further away than
+//                  the best node found. Only the part of each ring
+//                  inside the range of occupied cells is looked at,
+//                  and for a point outside that range the walk
+//                  starts at the first ring that reaches it.
+//  Arguments:      The point, and the furthest a node may be
+//                  (negative for no limit).
+//  Return Value:   The node id, or -1 if there is none in range.
+// ----------------------------------------------------------------
+inline int SpatialGrid::nearest( sf::Vector2f point, float maxDistance ) const {
+    if( m_count == 0 ) {
+        return -1;
+    }
+    int cx = cellOf( point.x );
+    int cy = cellOf( point.y );
+
+    // rings before the first and beyond the last cannot hold a node.
+    int first = std::max( std::max( m_minX - cx, cx - m_maxX ), std::max( m_minY - cy, cy - m_maxY ) );
+    int rings = std::max( std::max( cx - m_minX, m_maxX - cx ), std::max( cy - m_minY, m_maxY - cy ) );
+    if( first < 0 ) {
+        first = 0;
+    }
+    if( maxDistance >= 0.0f && (int)( maxDistance / m_cellSize ) + 1 < rings ) {
+        rings = (int)( maxDistance / m_cellSize ) + 1;
+    }
+
+    int best = -1;
+    float bestDistance = 0.0f;
+    for( int ring = first; ring <= rings; ring++ ) {
+        if( ring == 0 ) {
+            scanCell( cx, cy, point, bestDistance, best );
+        }
+        else {
+            // top and bottom rows, then the sides between them.
+            int x0 = std::max( cx - ring, m_minX ), x1 = std::min( cx + ring, m_maxX );
+            int y0 = std::max( cy - ring + 1, m_minY ), y1 = std::min( cy + ring - 1, m_maxY );
+            for( int x = x0; x <= x1 && cy - ring >= m_minY; x++ ) {
+                scanCell( x, cy - ring, point, bestDistance, best );
+            }
+            for( int x = x0; x <= x1 && cy + ring <= m_maxY; x++ ) {
+                scanCell( x, cy + ring, point, bestDistance, best );
+            }
+            for( int y = y0; y <= y1 && cx - ring >= m_minX; y++ ) {
+                scanCell( cx - ring, y, point, bestDistance, best );
+            }
+            for( int y = y0; y <= y1 && cx + ring <= m_maxX; y++ ) {
+                scanCell( cx + ring, y, point, bestDistance, best );
+            }
+        }
+        // anything in ring + 1 is at least ring cells away.
+        float reach = ring * m_cellSize;
+        if( best != -1 && bestDistance <= reach * reach ) {
+            break;
+        }
+    }
+
+    if( best != -1 && maxDistance >= 0.0f && bestDistance > maxDistance * maxDistance ) {
+        best = -1;
+    }
+    return best;
+}
+
+// ----------------------------------------------------------------
+//  Name:           inRadius
+//  Description:    Finds every node within a distance of a point.
+//  Arguments:      The point, the radius and the list to add the
+//                  node ids to.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialGrid::inRadius( sf::Vector2f point, float radius, std::vector<int>& found ) const {
+    size_t first = found.size();
+    inBox( point - sf::Vector2f( radius, radius ), point + sf::Vector2f( radius, radius ), found );
+
+    // drop the corners of the box.
+    size_t kept = first;
+    for( size_t i = first; i < found.size(); i++ ) {
+        sf::Vector2f d = m_positions[found[i]] - point;
+        if( d.x * d.x + d.y * d.y <= radius * radius ) {
+            found[kept++] = found[i];
+        }
+    }
+    found.resize( kept );
+}
+
+// ----------------------------------------------------------------
+//  Name:           inBox
+//  Description:    Finds every node inside a rectangle.
+//  Arguments:      The top left and bottom right corners, and the
+//                  list to add the node ids to.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialGrid::inBox( sf::Vector2f lo, sf::Vector2f hi, std::vector<int>& found ) const {
+    int x0 = cellOf( lo.x ), x1 = cellOf( hi.x );
+    int y0 = cellOf( lo.y ), y1 = cellOf( hi.y );
+    if( x0 < m_minX ) x0 = m_minX;
+    if( x1 > m_maxX ) x1 = m_maxX;
+    if( y0 < m_minY ) y0 = m_minY;
+    if( y1 > m_maxY ) y1 = m_maxY;
+
+    for( int x = x0; x <= x1; x++ ) {
+        for( int y = y0; y <= y1; y++ ) {
+            CellMap::const_iterator cell = m_cells.find( key( x, y ) );
+            if( cell == m_cells.end() ) {
+                continue;
+            }
+            std::vector<int> const & bucket = cell->second;
+            for( int i = 0; i < (int)bucket.size(); i++ ) {
+                sf::Vector2f p = m_positions[bucket[i]];
+                if( p.x >= lo.x && p.x <= hi.x && p.y >= lo.y && p.y <= hi.y ) {
+                    found.push_back( bucket[i] );
+                }
+            }
+        }
+    }
+}
+
+#endif
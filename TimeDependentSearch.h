@@ -0,0 +1,335 @@
+#ifndef TIMEDEPENDENTSEARCH_H
+#define TIMEDEPENDENTSEARCH_H
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "CompactGraph.h"
+#include "CostTraits.h"
+#include "PriorityQueues.h"
+
+// ----------------------------------------------------------------
+//  Name:           TravelTimes
+//  Description:    Time of day dependent travel times for the arcs
+//                  of one graph. A travel time function is a list
+//                  of (time, travel time) points, joined by straight
+//                  lines and repeating every period (a day, say), so
+//                  the last point leads back into the first. Many
+//                  arcs usually follow the same pattern, so the
+//                  functions are kept in a pool and each arc just
+//                  names one; arcs that name none keep the graph's
+//                  own weight at every time.
+//
+//                  Every function must be FIFO: leaving later never
+//                  gets you there sooner, i.e. no segment falls
+//                  faster than time passes (slope >= -1). That is
+//                  what lets the search settle each node once.
+// ----------------------------------------------------------------
+class TravelTimes {
+private:
+    struct Point {
+        double time;
+        double travel;
+    };
+
+    double m_period;
+
+// ----------------------------------------------------------------
+//  Description:    The function each arc follows, or -1.
+// ----------------------------------------------------------------
+    std::vector<int> m_function;
+
+// ----------------------------------------------------------------
+//  Description:    Function f's points are m_points[m_starts[f]]
+//                  up to m_points[m_starts[f + 1] - 1], in order of
+//                  time. m_minimum[f] is its smallest travel time.
+// ----------------------------------------------------------------
+    std::vector<int> m_starts;
+    std::vector<Point> m_points;
+    std::vector<double> m_minimum;
+
+public:
+    TravelTimes( int arcCount, double period )
+        : m_period( period ), m_function( arcCount, -1 ), m_starts( 1, 0 ) {}
+
+    // Accessors
+    double period() const {
+        return m_period;
+    }
+
+    int functionCount() const {
+        return (int)m_minimum.size();
+    }
+
+    int function( int arc ) const {
+        return m_function[arc];
+    }
+
+    double minimum( int function ) const {
+        return m_minimum[function];
+    }
+
+    size_t bytes() const {
+        return m_function.capacity() * sizeof( int ) + m_starts.capacity() * sizeof( int )
+             + m_points.capacity() * sizeof( Point ) + m_minimum.capacity() * sizeof( double );
+    }
+
+    int addFunction( std::vector<double> const & times, std::vector<double> const & travel );
+    bool assign( int arc, int function );
+    double travelTime( int function, double time ) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           addFunction
+//  Description:    Adds a travel time function to the pool.
+//  Arguments:      The times of its points, rising and within one
+//                  period, and the travel time at each.
+//  Return Value:   The function's id, or -1 if the points are out
+//                  of order or outside the period, a travel time is
+//                  negative, or the function is not FIFO.
+// ----------------------------------------------------------------
+inline int TravelTimes::addFunction( std::vector<double> const & times, std::vector<double> const & travel ) {
+    int n = (int)times.size();
+    if( n == 0 || (int)travel.size() != n || times[0] < 0.0 || times[n - 1] >= m_period ) {
+        return -1;
+    }
+    double minimum = travel[0];
+    for( int i = 0; i < n; i++ ) {
+        double nextTime = i + 1 < n ? times[i + 1] : times[0] + m_period;
+        double nextTravel = i + 1 < n ? travel[i + 1] : travel[0];
+        if( travel[i] < 0.0 || nextTime <= times[i] || nextTravel - travel[i] < times[i] - nextTime ) {
+            return -1;
+        }
+        minimum = std::min( minimum, travel[i] );
+    }
+
+    for( int i = 0; i < n; i++ ) {
+        Point point = { times[i], travel[i] };
+        m_points.push_back( point );
+    }
+    m_starts.push_back( (int)m_points.size() );
+    m_minimum.push_back( minimum );
+    return functionCount() - 1;
+}
+
+// ----------------------------------------------------------------
+//  Name:           assign
+//  Description:    Makes an arc follow a function, or (with -1) go
+//                  back to its fixed weight.
+//  Arguments:      The arc id and the function id.
+//  Return Value:   false if either id is out of range.
+// ----------------------------------------------------------------
+inline bool TravelTimes::assign( int arc, int function ) {
+    if( arc < 0 || arc >= (int)m_function.size() || function < -1 || function >= functionCount() ) {
+        return false;
+    }
+    m_function[arc] = function;
+    return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           travelTime
+//  Description:    Evaluates a function: finds the segment the time
+//                  of day falls in and interpolates along it.
+//  Arguments:      The function id and the time of leaving.
+//  Return Value:   The travel time.
+// ----------------------------------------------------------------
+inline double TravelTimes::travelTime( int function, double time ) const {
+    const Point* first = &m_points[m_starts[function]];
+    const Point* last = &m_points[m_starts[function + 1] - 1];
+    if( first == last ) {
+        return first->travel;
+    }
+    double t = std::fmod( time, m_period );
+    if( t < 0.0 ) {
+        t += m_period;
+    }
+
+    // the segment from the last point wraps round into the next period.
+    const Point* after = std::upper_bound( first, last + 1, t, []( double value, Point const & point ) {
+        return value < point.time;
+    } );
+    const Point* before;
+    double afterTime;
+    double afterTravel;
+    if( after == first || after > last ) {
+        before = last;
+        afterTime = first->time + m_period;
+        afterTravel = first->travel;
+        if( after == first ) {
+            t += m_period;
+        }
+    }
+    else {
+        before = after - 1;
+        afterTime = after->time;
+        afterTravel = after->travel;
+    }
+    return before->travel + ( afterTravel - before->travel ) * ( t - before->time ) / ( afterTime - before->time );
+}
+
+// ----------------------------------------------------------------
+//  Name:           TimeDependentSearch
+//  Description:    A* on arrival times. Leaving start at a given
+//                  time, each arc is costed at its travel time for
+//                  the moment it is entered, so a route can avoid a
+//                  road at rush hour and take it later on. With FIFO
+//                  functions the earliest arrival at a node is also
+//                  the best time to leave it, so, as in plain A*,
+//                  each node is expanded once.
+//
+//                  heuristic( node ) must never exceed the quickest
+//                  possible travel time from node to the goal at any
+//                  time of day, and must be consistent, e.g.
+//                  straight line distance over the top speed.
+//
+//                  GraphType gives the arcs and the fixed weights
+//                  (a CompactGraph, or a ProfiledGraph to combine
+//                  time of day with an agent's weight profile).
+//                  State is held per query as in AStarSearch.
+// ----------------------------------------------------------------
+template<class ArcType, class GraphType = CompactGraph<ArcType> >
+class TimeDependentSearch {
+private:
+    GraphType const & m_graph;
+    TravelTimes const & m_times;
+
+    std::vector<double> m_arrival;
+    std::vector<int> m_parent;
+    std::vector<bool> m_closed;
+    std::vector<int> m_touched;
+
+    BinaryHeapQueue<double> m_queue;
+    int m_expanded;
+
+    void reset();
+
+public:
+    TimeDependentSearch( GraphType const & graph, TravelTimes const & times )
+        : m_graph( graph ), m_times( times ), m_expanded( 0 ) {}
+
+    // Accessors
+    double arrival( int node ) const {
+        return m_arrival[node];
+    }
+
+    int parent( int node ) const {
+        return m_parent[node];
+    }
+
+    int expanded() const {
+        return m_expanded;
+    }
+
+    size_t scratchBytes() const {
+        return m_arrival.capacity() * sizeof( double ) + m_parent.capacity() * sizeof( int )
+             + m_closed.capacity() / 8 + m_touched.capacity() * sizeof( int ) + m_queue.bytes();
+    }
+
+    template<class Heuristic>
+    bool run( int start, double departure, int goal, Heuristic heuristic, std::vector<int>& path );
+};
+
+// ----------------------------------------------------------------
+//  Name:           reset
+//  Description:    Sizes the arrays to the graph and clears the
+//                  entries the last query touched.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType, class GraphType>
+void TimeDependentSearch<ArcType, GraphType>::reset() {
+    if( (int)m_arrival.size() != m_graph.size() ) {
+        m_arrival.assign( m_graph.size(), std::numeric_limits<double>::infinity() );
+        m_parent.assign( m_graph.size(), -1 );
+        m_closed.assign( m_graph.size(), false );
+    }
+    else {
+        for( int i = 0; i < (int)m_touched.size(); i++ ) {
+            m_arrival[m_touched[i]] = std::numeric_limits<double>::infinity();
+            m_parent[m_touched[i]] = -1;
+            m_closed[m_touched[i]] = false;
+        }
+    }
+    m_touched.clear();
+    m_queue.clear();
+    m_expanded = 0;
+}
+
+// ----------------------------------------------------------------
+//  Name:           run
+//  Description:    Finds the earliest arrival at goal.
+//  Arguments:      The start, the time of leaving it, the goal, the
+//                  heuristic (in time units) and the path to fill
+//                  in, start first. arrival( goal ) is then the time
+//                  of arrival.
+//  Return Value:   true if the goal was reached.
+// ----------------------------------------------------------------
+template<class ArcType, class GraphType>
+template<class Heuristic>
+bool TimeDependentSearch<ArcType, GraphType>::run( int start, double departure, int goal, Heuristic heuristic, std::vector<int>& path ) {
+    reset();
+    path.clear();
+    if( start < 0 || goal < 0 || !m_graph.present( start ) || !m_graph.present( goal ) ) {
+        return false;
+    }
+
+    m_arrival[start] = departure;
+    m_parent[start] = start;
+    m_touched.push_back( start );
+    m_queue.push( departure + heuristic( start ), start );
+
+    while( !m_queue.empty() ) {
+        double f;
+        int node = m_queue.pop( f );
+        if( m_closed[node] ) {
+            continue;
+        }
+        m_closed[node] = true;
+        m_expanded++;
+
+        if( node == goal ) {
+            for( int at = goal; ; at = m_parent[at] ) {
+                path.push_back( at );
+                if( at == start ) {
+                    break;
+                }
+            }
+            std::reverse( path.begin(), path.end() );
+            return true;
+        }
+
+        double leave = m_arrival[node];
+        for( int a = m_graph.begin( node ); a < m_graph.end( node ); a++ ) {
+            int child = m_graph.target( a );
+            if( m_closed[child] ) {
+                continue;
+            }
+            int function = m_times.function( a );
+            double travel;
+            if( function < 0 ) {
+                ArcType weight = m_graph.weight( a );
+                if( CostTraits<ArcType>::isInfinite( weight ) ) {
+                    continue;   // closed arc
+                }
+                travel = (double)weight;
+            }
+            else {
+                travel = m_times.travelTime( function, leave );
+            }
+            double arrive = leave + travel;
+            if( arrive < m_arrival[child] ) {
+                if( m_arrival[child] == std::numeric_limits<double>::infinity() ) {
+                    m_touched.push_back( child );
+                }
+                m_arrival[child] = arrive;
+                m_parent[child] = node;
+                m_queue.push( arrive + heuristic( child ), child );
+            }
+        }
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef VERSIONEDGRAPH_H
+#define VERSIONEDGRAPH_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "Graph.h"
+#include "CompactGraph.h"
+
+// ----------------------------------------------------------------
+//  Name:           GraphSnapshot
+//  Description:    One published version of a graph: its arcs and
+//                  the node positions (for heuristics). Never
+//                  changed once published, so any number of threads
+//                  can read it without locking.
+// ----------------------------------------------------------------
+template<class ArcType>
+struct GraphSnapshot {
+    CompactGraph<ArcType> graph;
+    std::vector<sf::Vector2f> positions;
+    unsigned version;
+};
+
+// ----------------------------------------------------------------
+//  Name:           GraphEdits
+//  Description:    A batch of map edits to apply together, so a
+//                  whole change becomes visible in one version.
+//                  Edits are applied in the order they were added.
+// ----------------------------------------------------------------
+template<class ArcType>
+class GraphEdits {
+private:
+    enum Kind { ADD_ARC, REMOVE_ARC, SET_WEIGHT, REMOVE_NODE };
+
+    struct Edit {
+        Kind kind;
+        int from;
+        int to;
+        ArcType weight;
+    };
+
+    std::vector<Edit> m_edits;
+
+    void add( Kind kind, int from, int to, ArcType weight ) {
+        Edit edit = { kind, from, to, weight };
+        m_edits.push_back( edit );
+    }
+
+public:
+    void addArc( int from, int to, ArcType weight ) {
+        add( ADD_ARC, from, to, weight );
+    }
+
+    void removeArc( int from, int to ) {
+        add( REMOVE_ARC, from, to, ArcType() );
+    }
+
+    void setWeight( int from, int to, ArcType weight ) {
+        add( SET_WEIGHT, from, to, weight );
+    }
+
+    void removeNode( int index ) {
+        add( REMOVE_NODE, index, -1, ArcType() );
+    }
+
+    void clear() {
+        m_edits.clear();
+    }
+
+    bool empty() const {
+        return m_edits.empty();
+    }
+
+    int size() const {
+        return (int)m_edits.size();
+    }
+
+    template<class NodeType>
+    void applyTo( Graph<NodeType, ArcType>& graph ) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           applyTo
+//  Description:    Makes the edits on a graph.
+//  Arguments:      The graph.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+template<class NodeType>
+void GraphEdits<ArcType>::applyTo( Graph<NodeType, ArcType>& graph ) const {
+    for( int i = 0; i < (int)m_edits.size(); i++ ) {
+        Edit const & edit = m_edits[i];
+        switch( edit.kind ) {
+        case ADD_ARC:
+            graph.addArc( edit.from, edit.to, edit.weight );
+            break;
+        case REMOVE_ARC:
+            graph.removeArc( edit.from, edit.to );
+            break;
+        case SET_WEIGHT:
+            if( graph.getArc( edit.from, edit.to ) != 0 ) {
+                graph.getArc( edit.from, edit.to )->setWeight( edit.weight );
+            }
+            break;
+        case REMOVE_NODE:
+            graph.removeNode( edit.from );
+            break;
+        }
+    }
+}
+
+// ----------------------------------------------------------------
+//  Name:           VersionedGraph
+//  Description:    Lets map edits and path queries run at the same
+//                  time. The Graph itself belongs to the writers:
+//                  edits are made to it under a lock and then
+//                  published as a new immutable GraphSnapshot,
+//                  which replaces the current one in a single
+//                  atomic store. Queries never touch the Graph or
+//                  its nodes (whose marks and data a query would
+//                  otherwise write); they pin a snapshot and search
+//                  it with AStarSearch, which keeps its state in
+//                  its own arrays.
+//
+//                  Snapshots are reference counted. A reader keeps
+//                  the version it pinned for as long as it likes,
+//                  and an old version is freed when the last reader
+//                  holding it lets go.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class VersionedGraph {
+public:
+    typedef GraphSnapshot<ArcType> Snapshot;
+    typedef std::shared_ptr<const Snapshot> SnapshotPtr;
+
+private:
+    Graph<NodeType, ArcType>& m_graph;
+    std::mutex m_writeLock;
+
+// ----------------------------------------------------------------
+//  Description:    The newest snapshot, only ever read and written
+//                  with std::atomic_load and std::atomic_store, and
+//                  its version number, which readers check first.
+// ----------------------------------------------------------------
+    SnapshotPtr m_current;
+    std::atomic<unsigned> m_version;
+
+    VersionedGraph( VersionedGraph const & );
+    VersionedGraph& operator=( VersionedGraph const & );
+
+    unsigned publish();
+
+public:
+    explicit VersionedGraph( Graph<NodeType, ArcType>& graph ) : m_graph( graph ), m_version( 0 ) {
+        publish();
+    }
+
+    // The newest snapshot.
+    SnapshotPtr snapshot() const {
+        return std::atomic_load( &m_current );
+    }
+
+    unsigned version() const {
+        return m_version.load( std::memory_order_acquire );
+    }
+
+    unsigned apply( GraphEdits<ArcType> const & edits );
+    template<class Edit>
+    unsigned update( Edit edit );
+
+// ----------------------------------------------------------------
+//  Name:           Reader
+//  Description:    A query thread's hold on a snapshot. pin() only
+//                  fetches a new snapshot once a new version has
+//                  been published, so between edits it costs one
+//                  atomic read. One Reader per thread.
+// ----------------------------------------------------------------
+    class Reader {
+    private:
+        VersionedGraph const & m_owner;
+        SnapshotPtr m_pinned;
+
+    public:
+        explicit Reader( VersionedGraph const & owner ) : m_owner( owner ) {}
+
+        Snapshot const & pin() {
+            if( !m_pinned || m_pinned->version != m_owner.version() ) {
+                m_pinned = m_owner.snapshot();
+            }
+            return *m_pinned;
+        }
+
+        // true when pin() would return a newer snapshot.
+        bool stale() const {
+            return !m_pinned || m_pinned->version != m_owner.version();
+        }
+
+        void release() {
+            m_pinned.reset();
+        }
+    };
+};
+
+// ----------------------------------------------------------------
+//  Name:           publish
+//  Description:    Copies the graph into a new snapshot and makes it
+//                  the current one. Called with the write lock held.
+//  Arguments:      None.
+//  Return Value:   The new version number.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+unsigned VersionedGraph<NodeType, ArcType>::publish() {
+    std::shared_ptr<Snapshot> pSnapshot( new Snapshot );
+    pSnapshot->graph.build( m_graph );
+    pSnapshot->positions.resize( m_graph.maxNodes() );
+    for( int i = 0; i < m_graph.maxNodes(); i++ ) {
+        if( m_graph.nodeArray()[i] != 0 ) {
+            pSnapshot->positions[i] = m_graph.nodeArray()[i]->getPosition();
+        }
+    }
+    pSnapshot->version = m_version.load( std::memory_order_relaxed ) + 1;
+
+    // the snapshot goes in before the version so a reader that sees
+    // the new number always finds a snapshot at least that new.
+    std::atomic_store( &m_current, SnapshotPtr( pSnapshot ) );
+    m_version.store( pSnapshot->version, std::memory_order_release );
+    return pSnapshot->version;
+}
+
+// ----------------------------------------------------------------
+//  Name:           apply
+//  Description:    Makes a batch of edits and publishes the result
+//                  as one new version. Writers take turns; readers
+//                  carry on with their pinned snapshots meanwhile.
+//  Arguments:      The edits.
+//  Return Value:   The new version number.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+unsigned VersionedGraph<NodeType, ArcType>::apply( GraphEdits<ArcType> const & edits ) {
+    std::lock_guard<std::mutex> lock( m_writeLock );
+    edits.applyTo( m_graph );
+    return publish();
+}
+
+// ----------------------------------------------------------------
+//  Name:           update
+//  Description:    As apply, for edits GraphEdits does not cover
+//                  (such as adding nodes): edit( graph ) is called
+//                  with the write lock held.
+//  Arguments:      The function that edits the graph.
+//  Return Value:   The new version number.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Edit>
+unsigned VersionedGraph<NodeType, ArcType>::update( Edit edit ) {
+    std::lock_guard<std::mutex> lock( m_writeLock );
+    edit( m_graph );
+    return publish();
+}
+
+#endif
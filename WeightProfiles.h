@@ -0,0 +1,215 @@
+#ifndef WEIGHTPROFILES_H
+#define WEIGHTPROFILES_H
+
+#include <vector>
+#include <string>
+#include "CompactGraph.h"
+#include "CostTraits.h"
+
+// ----------------------------------------------------------------
+//  Name:           WeightProfiles
+//  Description:    Alternative weights for the arcs of one
+//                  CompactGraph, one array per profile ("car",
+//                  "pedestrian", ...) indexed by arc id, so every
+//                  profile shares the graph's topology instead of
+//                  needing a copy of it. A weight of
+//                  CostTraits<Weight>::infinity() closes an arc to
+//                  that profile.
+//
+//                  The profiles are only valid for the graph they
+//                  were made for; a rebuild or reordering of the
+//                  graph changes the arc ids.
+// ----------------------------------------------------------------
+template<class Weight>
+class WeightProfiles {
+private:
+    int m_arcCount;
+    std::vector<std::string> m_names;
+
+// ----------------------------------------------------------------
+//  Description:    The weights of each profile. Adding a profile
+//                  leaves the arrays of the others where they are.
+// ----------------------------------------------------------------
+    std::vector< std::vector<Weight> > m_weights;
+
+public:
+    explicit WeightProfiles( int arcCount ) : m_arcCount( arcCount ) {}
+
+    template<class ArcType>
+    explicit WeightProfiles( CompactGraph<ArcType> const & graph ) : m_arcCount( graph.arcCount() ) {}
+
+    // Accessors
+    int count() const {
+        return (int)m_weights.size();
+    }
+
+    int arcCount() const {
+        return m_arcCount;
+    }
+
+    std::string const & name( int profile ) const {
+        return m_names[profile];
+    }
+
+    Weight weight( int profile, int arc ) const {
+        return m_weights[profile][arc];
+    }
+
+    Weight const * weights( int profile ) const {
+        return m_weights[profile].empty() ? 0 : &m_weights[profile][0];
+    }
+
+    void setWeight( int profile, int arc, Weight weight ) {
+        m_weights[profile][arc] = weight;
+    }
+
+    size_t bytes() const {
+        return (size_t)m_arcCount * sizeof( Weight ) * m_weights.size();
+    }
+
+    int add( std::string const & name, std::vector<Weight> const & weights );
+    template<class ArcType, class Rule>
+    int add( std::string const & name, CompactGraph<ArcType> const & graph, Rule rule );
+    int find( std::string const & name ) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           add
+//  Description:    Adds a profile from its weights.
+//  Arguments:      The profile's name and a weight for every arc.
+//  Return Value:   The new profile's id, or -1 if the number of
+//                  weights does not match the graph.
+// ----------------------------------------------------------------
+template<class Weight>
+int WeightProfiles<Weight>::add( std::string const & name, std::vector<Weight> const & weights ) {
+    if( (int)weights.size() != m_arcCount ) {
+        return -1;
+    }
+    m_names.push_back( name );
+    m_weights.push_back( weights );
+    return count() - 1;
+}
+
+// ----------------------------------------------------------------
+//  Name:           add
+//  Description:    Adds a profile worked out from the graph: the
+//                  weight of each arc is rule( from, to, weight ),
+//                  for instance the base weight times a slowdown,
+//                  or infinity to close the arc.
+//  Arguments:      The profile's name, the graph and the rule.
+//  Return Value:   The new profile's id, or -1 if the graph is not
+//                  the one the profiles are for.
+// ----------------------------------------------------------------
+template<class Weight>
+template<class ArcType, class Rule>
+int WeightProfiles<Weight>::add( std::string const & name, CompactGraph<ArcType> const & graph, Rule rule ) {
+    if( graph.arcCount() != m_arcCount ) {
+        return -1;
+    }
+    std::vector<Weight> weights( m_arcCount );
+    for( int node = 0; node < graph.size(); node++ ) {
+        for( int a = graph.begin( node ); a < graph.end( node ); a++ ) {
+            weights[a] = rule( node, graph.target( a ), graph.weight( a ) );
+        }
+    }
+    m_names.push_back( name );
+    m_weights.push_back( std::vector<Weight>() );
+    m_weights.back().swap( weights );
+    return count() - 1;
+}
+
+// ----------------------------------------------------------------
+//  Name:           find
+//  Description:    Looks a profile up by name.
+//  Arguments:      The name.
+//  Return Value:   The profile's id, or -1.
+// ----------------------------------------------------------------
+template<class Weight>
+int WeightProfiles<Weight>::find( std::string const & name ) const {
+    for( int i = 0; i < count(); i++ ) {
+        if( m_names[i] == name ) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// ----------------------------------------------------------------
+//  Name:           ProfiledGraph
+//  Description:    A CompactGraph seen through one of its weight
+//                  profiles: the same nodes and forward arcs, with
+//                  weight( arc ) taken from the selected profile.
+//                  It is only a pair of references and a pointer,
+//                  so each search thread can keep its own and
+//                  select the profile each query asks for:
+//
+//                      ProfiledGraph<int> view( graph, profiles );
+//                      AStarSearch<int, int, Queue, ProfiledGraph<int> > search( view );
+//                      view.select( profiles.find( "pedestrian" ) );
+//                      search.run( start, goal, heuristic, path );
+//
+//                  Like PackedGraph it has no reverse arcs.
+// ----------------------------------------------------------------
+template<class Weight, class ArcType = Weight>
+class ProfiledGraph {
+private:
+    CompactGraph<ArcType> const & m_graph;
+    WeightProfiles<Weight> const & m_profiles;
+    Weight const * m_weights;
+    int m_profile;
+
+public:
+    ProfiledGraph( CompactGraph<ArcType> const & graph, WeightProfiles<Weight> const & profiles, int profile = 0 )
+        : m_graph( graph ), m_profiles( profiles ), m_weights( 0 ), m_profile( -1 ) {
+        select( profile );
+    }
+
+    // Picks the profile the weights come from.
+    bool select( int profile ) {
+        if( profile < 0 || profile >= m_profiles.count() ) {
+            return false;
+        }
+        m_profile = profile;
+        m_weights = m_profiles.weights( profile );
+        return true;
+    }
+
+    // Accessors
+    int profile() const {
+        return m_profile;
+    }
+
+    int size() const {
+        return m_graph.size();
+    }
+
+    int arcCount() const {
+        return m_graph.arcCount();
+    }
+
+    bool present( int node ) const {
+        return m_graph.present( node );
+    }
+
+    int begin( int node ) const {
+        return m_graph.begin( node );
+    }
+
+    int end( int node ) const {
+        return m_graph.end( node );
+    }
+
+    int target( int arc ) const {
+        return m_graph.target( arc );
+    }
+
+    Weight weight( int arc ) const {
+        return m_weights[arc];
+    }
+
+    int degree( int node ) const {
+        return m_graph.degree( node );
+    }
+};
+
+#endif